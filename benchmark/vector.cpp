@@ -1,7 +1,22 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <ciel/arena_allocator.hpp>
+#include <ciel/heap_queue.hpp>
+#include <ciel/malloc_allocator.hpp>
+#include <ciel/poly_vector.hpp>
+#include <ciel/pool_allocator.hpp>
+#include <ciel/spill_vector.hpp>
+#include <ciel/static_search_index.hpp>
 #include <ciel/vector.hpp>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <queue>
+#include <random>
+#include <scoped_allocator>
+#include <span>
 #include <vector>
 
 namespace {
@@ -140,3 +155,344 @@ BENCHMARK(vector_int_erase_std)->Arg(10000);
 BENCHMARK(vector_int_erase_ciel)->Arg(10000);
 BENCHMARK(vector_tr_erase_std)->Arg(10000);
 BENCHMARK(vector_tr_erase_ciel)->Arg(10000);
+
+// priority queue
+
+template <class Queue>
+static void bench_priority_queue_impl(benchmark::State& state) {
+  std::mt19937 gen(0);
+  ciel::vector<int> input(state.range(0));
+  for (auto& e : input) {
+    e = static_cast<int>(gen());
+  }
+
+  for (auto _ : state) {
+    Queue q;
+
+    for (const int e : input) {
+      q.push(e);
+    }
+
+    while (!q.empty()) {
+      benchmark::DoNotOptimize(q.top());
+      q.pop();
+    }
+
+    benchmark::ClobberMemory();
+  }
+}
+
+static void priority_queue_int_std(benchmark::State& state) {
+  bench_priority_queue_impl<std::priority_queue<int, ciel::vector<int>>>(state);
+}
+static void heap_queue_int_binary_ciel(benchmark::State& state) {
+  bench_priority_queue_impl<ciel::heap_queue<int, 2>>(state);
+}
+static void heap_queue_int_quaternary_ciel(benchmark::State& state) {
+  bench_priority_queue_impl<ciel::heap_queue<int, 4>>(state);
+}
+
+BENCHMARK(priority_queue_int_std)->Arg(1000000);
+BENCHMARK(heap_queue_int_binary_ciel)->Arg(1000000);
+BENCHMARK(heap_queue_int_quaternary_ciel)->Arg(1000000);
+
+// sorted search
+
+static void bench_search_input(const size_t n, ciel::vector<uint64_t>& keys, ciel::vector<uint64_t>& queries) {
+  std::mt19937_64 gen(0);
+  keys.resize(n);
+  for (auto& e : keys) {
+    e = gen();
+  }
+  std::sort(keys.begin(), keys.end());
+
+  queries.resize(1 << 16);
+  for (auto& e : queries) {
+    e = gen();
+  }
+}
+
+static void lower_bound_uint64_std(benchmark::State& state) {
+  ciel::vector<uint64_t> keys;
+  ciel::vector<uint64_t> queries;
+  bench_search_input(state.range(0), keys, queries);
+
+  for (auto _ : state) {
+    for (const uint64_t q : queries) {
+      benchmark::DoNotOptimize(std::lower_bound(keys.begin(), keys.end(), q));
+    }
+  }
+}
+
+static void lower_bound_uint64_static_search_index_ciel(benchmark::State& state) {
+  ciel::vector<uint64_t> keys;
+  ciel::vector<uint64_t> queries;
+  bench_search_input(state.range(0), keys, queries);
+  const ciel::static_search_index<uint64_t> index(keys);
+
+  for (auto _ : state) {
+    for (const uint64_t q : queries) {
+      benchmark::DoNotOptimize(index.lower_bound(q));
+    }
+  }
+}
+
+static void lower_bound_uint64_static_search_index_batch_ciel(benchmark::State& state) {
+  ciel::vector<uint64_t> keys;
+  ciel::vector<uint64_t> queries;
+  bench_search_input(state.range(0), keys, queries);
+  const ciel::static_search_index<uint64_t> index(keys);
+  ciel::vector<size_t> out(queries.size());
+
+  for (auto _ : state) {
+    index.lower_bound(queries, out);
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK(lower_bound_uint64_std)->Arg(10000000);
+BENCHMARK(lower_bound_uint64_static_search_index_ciel)->Arg(10000000);
+BENCHMARK(lower_bound_uint64_static_search_index_batch_ciel)->Arg(10000000);
+
+// polymorphic iteration
+
+struct handler {
+  virtual ~handler() = default;
+  virtual int handle(int x) const = 0;
+};
+
+struct add_handler final : handler {
+  int n;
+  explicit add_handler(int n_) : n{n_} {}
+  int handle(int x) const override { return x + n; }
+};
+
+struct xor_handler final : handler {
+  int n;
+  long long pad{0};
+  explicit xor_handler(int n_) : n{n_} {}
+  int handle(int x) const override { return x ^ n; }
+};
+
+static void iterate_unique_ptr_std(benchmark::State& state) {
+  ciel::vector<std::unique_ptr<handler>> v;
+  for (int i = 0; i < state.range(0); ++i) {
+    if (i % 2 == 0) {
+      v.emplace_back(std::make_unique<add_handler>(i));
+    } else {
+      v.emplace_back(std::make_unique<xor_handler>(i));
+    }
+  }
+
+  for (auto _ : state) {
+    int x = 0;
+    for (const auto& h : v) {
+      x = h->handle(x);
+    }
+    benchmark::DoNotOptimize(x);
+  }
+}
+
+static void iterate_poly_vector_ciel(benchmark::State& state) {
+  ciel::poly_vector<handler> v;
+  for (int i = 0; i < state.range(0); ++i) {
+    if (i % 2 == 0) {
+      v.emplace_back<add_handler>(i);
+    } else {
+      v.emplace_back<xor_handler>(i);
+    }
+  }
+
+  for (auto _ : state) {
+    int x = 0;
+    for (const handler& h : v) {
+      x = h.handle(x);
+    }
+    benchmark::DoNotOptimize(x);
+  }
+}
+
+BENCHMARK(iterate_unique_ptr_std)->Arg(1000000);
+BENCHMARK(iterate_poly_vector_ciel)->Arg(1000000);
+
+// append then scan with a memory budget
+
+static void append_scan_uint64_vector_ciel(benchmark::State& state) {
+  for (auto _ : state) {
+    ciel::vector<uint64_t> v;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      v.push_back(i);
+    }
+
+    uint64_t sum = 0;
+    for (const uint64_t x : v) {
+      sum += x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+static void append_scan_uint64_spill_vector_ciel(benchmark::State& state) {
+  for (auto _ : state) {
+    // A quarter of the data stays resident.
+    ciel::spill_vector<uint64_t> v(state.range(0) * sizeof(uint64_t) / 4);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      v.push_back(i);
+    }
+
+    uint64_t sum = 0;
+    v.for_each_chunk([&](std::span<const uint64_t> chunk) {
+      for (const uint64_t x : chunk) {
+        sum += x;
+      }
+    });
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(append_scan_uint64_vector_ciel)->Arg(1 << 24);
+BENCHMARK(append_scan_uint64_spill_vector_ciel)->Arg(1 << 24);
+
+// per-request scratch vectors
+
+static void scratch_int_vector_ciel(benchmark::State& state) {
+  for (auto _ : state) {
+    ciel::vector<int> v;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      v.push_back(static_cast<int>(i));
+    }
+    benchmark::DoNotOptimize(v.data());
+  }
+}
+
+static void scratch_int_arena_vector_ciel(benchmark::State& state) {
+  ciel::monotonic_arena arena(state.range(0) * sizeof(int) * 2);
+
+  for (auto _ : state) {
+    {
+      ciel::arena_vector<int> v(arena);
+      for (int64_t i = 0; i < state.range(0); ++i) {
+        v.push_back(static_cast<int>(i));
+      }
+      benchmark::DoNotOptimize(v.data());
+    }
+    arena.reset();
+  }
+}
+
+BENCHMARK(scratch_int_vector_ciel)->Arg(10000);
+BENCHMARK(scratch_int_arena_vector_ciel)->Arg(10000);
+
+// short-lived vectors on many threads
+
+template <class V>
+static void bench_short_lived_impl(benchmark::State& state) {
+  for (auto _ : state) {
+    for (int round = 0; round < 100; ++round) {
+      V v;
+      for (int64_t i = 0; i < state.range(0); ++i) {
+        v.push_back(static_cast<int>(i));
+      }
+      benchmark::DoNotOptimize(v.data());
+    }
+  }
+}
+
+static void short_lived_int_vector_ciel(benchmark::State& state) {
+  bench_short_lived_impl<ciel::vector<int>>(state);
+}
+
+static void short_lived_int_pool_vector_ciel(benchmark::State& state) {
+  bench_short_lived_impl<ciel::pool_vector<int>>(state);
+}
+
+BENCHMARK(short_lived_int_vector_ciel)->Arg(100)->Threads(1)->Threads(8);
+BENCHMARK(short_lived_int_pool_vector_ciel)->Arg(100)->Threads(1)->Threads(8);
+
+// std::pmr
+
+template <class Container>
+static void bench_pmr_emplace_back_impl(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::pmr::monotonic_buffer_resource resource;
+    Container v(&resource);
+    state.ResumeTiming();
+
+    for (int i = 0; i < state.range(0); ++i) {
+      v.emplace_back(i);
+    }
+
+    benchmark::DoNotOptimize(v);
+    benchmark::ClobberMemory();
+  }
+}
+
+static void pmr_vector_int_emplace_back_std(benchmark::State& state) {
+  bench_pmr_emplace_back_impl<std::pmr::vector<int>>(state);
+}
+static void pmr_vector_int_emplace_back_ciel(benchmark::State& state) {
+  bench_pmr_emplace_back_impl<ciel::pmr::vector<int>>(state);
+}
+static void pmr_vector_tr_emplace_back_std(benchmark::State& state) {
+  bench_pmr_emplace_back_impl<std::pmr::vector<tr>>(state);
+}
+static void pmr_vector_tr_emplace_back_ciel(benchmark::State& state) {
+  bench_pmr_emplace_back_impl<ciel::pmr::vector<tr>>(state);
+}
+
+BENCHMARK(pmr_vector_int_emplace_back_std)->Arg(100000);
+BENCHMARK(pmr_vector_int_emplace_back_ciel)->Arg(100000);
+BENCHMARK(pmr_vector_tr_emplace_back_std)->Arg(100000);
+BENCHMARK(pmr_vector_tr_emplace_back_ciel)->Arg(100000);
+
+// nested vectors
+
+static void nested_vector_int_std(benchmark::State& state) {
+  for (auto _ : state) {
+    std::vector<std::vector<int>> v;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      v.emplace_back(8, static_cast<int>(i));
+    }
+    benchmark::DoNotOptimize(v.data());
+  }
+}
+
+static void nested_vector_int_scoped_arena_ciel(benchmark::State& state) {
+  using inner = ciel::arena_vector<int>;
+
+  ciel::monotonic_arena arena;
+  for (auto _ : state) {
+    {
+      ciel::vector<inner, std::scoped_allocator_adaptor<ciel::arena_allocator<inner>>> v(arena);
+      for (int64_t i = 0; i < state.range(0); ++i) {
+        v.emplace_back(8, static_cast<int>(i));
+      }
+      benchmark::DoNotOptimize(v.data());
+    }
+    arena.reset();
+  }
+}
+
+BENCHMARK(nested_vector_int_std)->Arg(100000);
+BENCHMARK(nested_vector_int_scoped_arena_ciel)->Arg(100000);
+
+// value-initialized construction
+
+static void construct_size_double_ciel(benchmark::State& state) {
+  for (auto _ : state) {
+    ciel::vector<double> v(state.range(0));
+    benchmark::DoNotOptimize(v.data());
+  }
+}
+
+static void construct_size_double_calloc_ciel(benchmark::State& state) {
+  for (auto _ : state) {
+    ciel::vector<double, ciel::malloc_allocator<double>> v(state.range(0));
+    benchmark::DoNotOptimize(v.data());
+  }
+}
+
+BENCHMARK(construct_size_double_ciel)->Arg(1 << 24);
+BENCHMARK(construct_size_double_calloc_ciel)->Arg(1 << 24);
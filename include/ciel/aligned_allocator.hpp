@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== aligned_allocator ====================
+
+// An allocator whose allocations are aligned to Alignment bytes, e.g. 32 for AVX, 64 for a cache line
+// or 4096 for a page.
+//
+// With vector, capacity is rounded up to whole lanes of min(Alignment, 64) bytes, so SIMD kernels can
+// process a full-width tail within capacity() instead of a scalar epilogue.
+//
+// It doesn't provide construct or destroy, so vector keeps its memcpy and memmove paths.
+template <class T, size_t Alignment = 64>
+class aligned_allocator {
+  static_assert(std::has_single_bit(Alignment), "Alignment must be a power of 2.");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  static constexpr size_t alignment = std::max(Alignment, alignof(T));
+
+  static constexpr size_t capacity_granularity =
+      std::min<size_t>(alignment, 64) % sizeof(T) == 0 ? std::max<size_t>(std::min<size_t>(alignment, 64) / sizeof(T), 1)
+                                                       : 1;
+
+  template <class U>
+  struct rebind {
+    using other = aligned_allocator<U, Alignment>;
+  };
+
+  constexpr aligned_allocator() noexcept = default;
+
+  template <class U>
+  constexpr aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+  [[nodiscard]] T* allocate(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_array_new_length{});
+    }
+
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignment}));
+  }
+
+  void deallocate(T* p, const size_type n) noexcept {
+#ifdef __cpp_sized_deallocation
+    ::operator delete(p, n * sizeof(T), std::align_val_t{alignment});
+#else
+    (void)n;
+    ::operator delete(p, std::align_val_t{alignment});
+#endif
+  }
+
+  [[nodiscard]] constexpr size_type max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+  }
+
+  template <class U>
+  [[nodiscard]] friend constexpr bool operator==(const aligned_allocator&,
+                                                 const aligned_allocator<U, Alignment>&) noexcept {
+    return true;
+  }
+
+};  // class aligned_allocator
+
+template <class T, size_t Alignment = 64>
+using aligned_vector = vector<T, aligned_allocator<T, Alignment>>;
+
+}  // namespace v
+}  // namespace ciel
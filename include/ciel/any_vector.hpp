@@ -0,0 +1,403 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "aligned_allocator.hpp"
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== element_ops ====================
+
+// Runtime description of an element type for any_vector. Every operation works on a batch of n elements,
+// so processing a range costs one indirect call. Constructing operations must not leave anything constructed
+// if they throw. relocate moves elements from src to dst then destroys them, in ascending order, so it also
+// works on overlapping ranges with dst < src.
+//
+// A null function pointer means the operation is trivial: zero bytes, memcpy, or nothing. For a type that is
+// not trivially copyable, a null copy_construct means it is not copyable. default_construct is null only when
+// the type is not default constructible, or when zero_initializable says a value-initialized object is all
+// zero bytes.
+struct element_ops {
+  size_t size;
+  size_t alignment;
+  bool trivially_copyable;
+  bool trivially_relocatable;
+  bool default_constructible;
+  bool zero_initializable;
+  void (*default_construct)(void* dst, size_t n);
+  void (*copy_construct)(void* dst, const void* src, size_t n);
+  void (*relocate)(void* dst, void* src, size_t n) noexcept;
+  void (*destroy)(void* p, size_t n) noexcept;
+};
+
+template <class T>
+[[nodiscard]] constexpr element_ops make_element_ops() noexcept {
+  static_assert(std::is_same_v<T, std::remove_cv_t<T>> && std::is_object_v<T>);
+  static_assert(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>,
+                "any_vector relocates elements, which must not throw.");
+
+  constexpr bool zero_initializable = std::is_trivially_default_constructible_v<T> && is_zero_initializable_v<T>;
+
+  element_ops res{sizeof(T),
+                  alignof(T),
+                  std::is_trivially_copyable_v<T>,
+                  is_trivially_relocatable_v<T>,
+                  std::is_default_constructible_v<T>,
+                  zero_initializable,
+                  nullptr,
+                  nullptr,
+                  nullptr,
+                  nullptr};
+
+  if constexpr (std::is_default_constructible_v<T> && !zero_initializable) {
+    res.default_construct = [](void* dst, const size_t n) {
+      std::uninitialized_value_construct_n(static_cast<T*>(dst), n);
+    };
+  }
+
+  if constexpr (!std::is_trivially_copyable_v<T> && std::is_copy_constructible_v<T>) {
+    res.copy_construct = [](void* dst, const void* src, const size_t n) {
+      std::uninitialized_copy_n(static_cast<const T*>(src), n, static_cast<T*>(dst));
+    };
+  }
+
+  if constexpr (!is_trivially_relocatable_v<T>) {
+    res.relocate = [](void* dst, void* src, const size_t n) noexcept {
+      T* d = static_cast<T*>(dst);
+      T* s = static_cast<T*>(src);
+
+      for (size_t i = 0; i < n; ++i) {
+        ::new (static_cast<void*>(d + i)) T(std::move(s[i]));
+        s[i].~T();
+      }
+    };
+  }
+
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    res.destroy = [](void* p, const size_t n) noexcept { std::destroy_n(static_cast<T*>(p), n); };
+  }
+
+  return res;
+}
+
+template <class T>
+inline constexpr element_ops element_ops_for = make_element_ops<T>();
+
+// ==================== any_vector ====================
+
+// A vector whose element type is only known at runtime through an element_ops, e.g. across plugin boundaries.
+// The elements are stored in a byte vector, so trivially relocatable types grow and erase through vector's
+// memcpy and memmove paths. Other types go through ops.relocate, once per batch.
+template <class Allocator = aligned_allocator<std::byte, 64>>
+class any_vector {
+  static_assert(std::is_same_v<typename Allocator::value_type, std::byte>);
+
+ public:
+  using allocator_type = Allocator;
+  using size_type = size_t;
+
+ private:
+  using bytes_type = vector<std::byte, allocator_type>;
+
+  template <class Alloc, class = void>
+  struct allocator_alignment : std::integral_constant<size_t, __STDCPP_DEFAULT_NEW_ALIGNMENT__> {};
+
+  template <class Alloc>
+  struct allocator_alignment<Alloc, std::void_t<decltype(Alloc::alignment)>>
+      : std::integral_constant<size_t, Alloc::alignment> {};
+
+  const element_ops* ops_;
+  bytes_type bytes_;
+
+  [[nodiscard]] std::byte* at_index(const size_type pos) noexcept { return bytes_.data() + pos * ops_->size; }
+
+  [[nodiscard]] const std::byte* at_index(const size_type pos) const noexcept {
+    return bytes_.data() + pos * ops_->size;
+  }
+
+  void grow_to(const size_type new_cap) {
+    const size_type new_cap_bytes = new_cap * ops_->size;
+
+    if (ops_->trivially_relocatable) {
+      bytes_.reserve(new_cap_bytes);
+      return;
+    }
+
+    bytes_type new_bytes(reserve_capacity, new_cap_bytes, bytes_.get_allocator());
+
+    if (!bytes_.empty()) {
+      ops_->relocate(new_bytes.data(), bytes_.data(), size());
+      new_bytes.unchecked_set_size(bytes_.size());
+      bytes_.unchecked_set_size(0);
+    }
+
+    bytes_.swap(new_bytes);
+  }
+
+  // Appends count elements constructed by construct(dst), which must not leave anything constructed if it throws.
+  // On reallocation they are constructed in the new buffer before the old elements are relocated and freed, so
+  // construct may read the current elements.
+  template <class Construct>
+  void append_with(const size_type count, Construct&& construct) {
+    const size_type old_size = size();
+    const size_type new_size = old_size + count;
+
+    if (new_size <= capacity()) {
+      construct(at_index(old_size));
+      bytes_.unchecked_set_size(new_size * ops_->size);
+      return;
+    }
+
+    if (count > bytes_.max_size() / ops_->size - old_size) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::length_error("ciel::any_vector expanding size is beyond max_size"));
+    }
+
+    bytes_type new_bytes(reserve_capacity, bytes_.recommend_cap(new_size * ops_->size), bytes_.get_allocator());
+    construct(new_bytes.data() + old_size * ops_->size);
+
+    if (old_size != 0) {
+      if (ops_->relocate) {
+        ops_->relocate(new_bytes.data(), bytes_.data(), old_size);
+
+      } else {
+        std::memcpy(new_bytes.data(), bytes_.data(), old_size * ops_->size);
+      }
+    }
+
+    new_bytes.unchecked_set_size(new_size * ops_->size);
+    bytes_.unchecked_set_size(0);
+    bytes_.swap(new_bytes);
+  }
+
+  void destroy_range(std::byte* p, const size_type count) noexcept {
+    if (ops_->destroy && count != 0) {
+      ops_->destroy(p, count);
+    }
+  }
+
+ public:
+  explicit any_vector(const element_ops& ops, const allocator_type& alloc = allocator_type())
+      : ops_{std::addressof(ops)}, bytes_(alloc) {
+    if (ops.size == 0 || ops.alignment > allocator_alignment<allocator_type>::value ||
+        ops.size % ops.alignment != 0) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::invalid_argument("ciel::any_vector element_ops is not supported"));
+    }
+  }
+
+  any_vector(const any_vector& other) : any_vector(*other.ops_, other.bytes_.get_allocator()) {
+    append_copy(other.data(), other.size());
+  }
+
+  any_vector(any_vector&& other) noexcept : ops_{other.ops_}, bytes_(std::move(other.bytes_)) {}
+
+  any_vector& operator=(const any_vector& other) {
+    if (this != std::addressof(other)) {
+      any_vector(other).swap(*this);
+    }
+
+    return *this;
+  }
+
+  any_vector& operator=(any_vector&& other) noexcept {
+    any_vector(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~any_vector() { clear(); }
+
+  allocator_type get_allocator() const noexcept { return bytes_.get_allocator(); }
+
+  [[nodiscard]] const element_ops& ops() const noexcept { return *ops_; }
+
+  [[nodiscard]] void* operator[](const size_type pos) noexcept {
+    assert(pos < size());
+
+    return at_index(pos);
+  }
+
+  [[nodiscard]] const void* operator[](const size_type pos) const noexcept {
+    assert(pos < size());
+
+    return at_index(pos);
+  }
+
+  [[nodiscard]] void* at(const size_type pos) {
+    if (pos >= size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::any_vector::at pos is not within the range"));
+    }
+
+    return at_index(pos);
+  }
+
+  [[nodiscard]] const void* at(const size_type pos) const {
+    if (pos >= size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::any_vector::at pos is not within the range"));
+    }
+
+    return at_index(pos);
+  }
+
+  // Typed access, T must be the type ops() describes.
+  template <class T>
+  [[nodiscard]] T& get(const size_type pos) noexcept {
+    assert(sizeof(T) == ops_->size);
+
+    return *std::launder(static_cast<T*>((*this)[pos]));
+  }
+
+  template <class T>
+  [[nodiscard]] const T& get(const size_type pos) const noexcept {
+    assert(sizeof(T) == ops_->size);
+
+    return *std::launder(static_cast<const T*>((*this)[pos]));
+  }
+
+  [[nodiscard]] void* data() noexcept { return bytes_.data(); }
+
+  [[nodiscard]] const void* data() const noexcept { return bytes_.data(); }
+
+  [[nodiscard]] bool empty() const noexcept { return bytes_.empty(); }
+
+  [[nodiscard]] size_type size() const noexcept { return bytes_.size() / ops_->size; }
+
+  [[nodiscard]] size_type capacity() const noexcept { return bytes_.capacity() / ops_->size; }
+
+  void reserve(const size_type new_cap) {
+    if (new_cap > capacity()) {
+      grow_to(new_cap);
+    }
+  }
+
+  void clear() noexcept {
+    destroy_range(bytes_.data(), size());
+    bytes_.clear();
+  }
+
+  // Appends count value-initialized elements. Throws invalid_argument if the element type is not default
+  // constructible.
+  void append_default(const size_type count) {
+    if (count == 0) {
+      return;
+    }
+
+    if (!ops_->default_constructible) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::invalid_argument("ciel::any_vector element type is not default constructible"));
+    }
+
+    append_with(count, [&](std::byte* dst) {
+      if (ops_->default_construct) {
+        ops_->default_construct(dst, count);
+
+      } else {
+        assert(ops_->zero_initializable);
+
+        std::memset(dst, 0, count * ops_->size);
+      }
+    });
+  }
+
+  // Appends copies of the count elements at src, which may be elements of this any_vector.
+  void append_copy(const void* src, const size_type count) {
+    if (count == 0) {
+      return;
+    }
+
+    assert(ops_->trivially_copyable || ops_->copy_construct);
+
+    append_with(count, [&](std::byte* dst) {
+      if (ops_->trivially_copyable) {
+        std::memcpy(dst, src, count * ops_->size);
+
+      } else {
+        ops_->copy_construct(dst, src, count);
+      }
+    });
+  }
+
+  // Appends the count elements at src by relocation, they are not alive anymore afterwards.
+  void append_relocate(void* src, const size_type count) {
+    if (count == 0) {
+      return;
+    }
+
+    append_with(count, [&](std::byte* dst) {
+      if (ops_->relocate) {
+        ops_->relocate(dst, src, count);
+
+      } else {
+        std::memcpy(dst, src, count * ops_->size);
+      }
+    });
+  }
+
+  void push_back(const void* src) { append_copy(src, 1); }
+
+  void pop_back() noexcept {
+    assert(!empty());
+
+    destroy_range(at_index(size() - 1), 1);
+    bytes_.erase(bytes_.end() - ops_->size, bytes_.end());
+  }
+
+  void resize(const size_type count) {
+    if (count > size()) {
+      append_default(count - size());
+
+    } else {
+      erase(count, size());
+    }
+  }
+
+  // Erases elements [first, last).
+  void erase(const size_type first, const size_type last) noexcept {
+    assert(first <= last);
+    assert(last <= size());
+
+    const size_type count = last - first;
+    if (count == 0) {
+      return;
+    }
+
+    destroy_range(at_index(first), count);
+
+    if (ops_->relocate && last != size()) {
+      ops_->relocate(at_index(first), at_index(last), size() - last);
+      bytes_.erase(bytes_.end() - count * ops_->size, bytes_.end());
+
+    } else {
+      bytes_.erase(bytes_.begin() + first * ops_->size, bytes_.begin() + last * ops_->size);
+    }
+  }
+
+  void erase(const size_type pos) noexcept { erase(pos, pos + 1); }
+
+  void swap(any_vector& other) noexcept {
+    std::swap(ops_, other.ops_);
+    bytes_.swap(other.bytes_);
+  }
+
+};  // class any_vector
+
+template <class Allocator>
+struct is_trivially_relocatable<any_vector<Allocator>> : is_trivially_relocatable<vector<std::byte, Allocator>> {};
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class Alloc>
+void swap(ciel::any_vector<Alloc>& lhs, ciel::any_vector<Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
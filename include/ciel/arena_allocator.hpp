@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== monotonic_arena ====================
+
+// A bump pointer arena: allocation advances a pointer through the current block, and a new block twice as large
+// is taken from operator new when it's used up. Memory is only given back by reset() and the destructor, except
+// for the most recent allocation, which can be grown in place or rolled back.
+//
+// That suits vector growth: a vector whose buffer is the last thing allocated grows without moving or copying,
+// and reallocation frees the old buffer for the next one when it's still on top.
+//
+// Not thread safe.
+class monotonic_arena {
+ public:
+  static constexpr size_t default_block_bytes = 4096;
+
+ private:
+  struct block {
+    block* prev;
+    size_t bytes;  // header included
+  };
+
+  static constexpr size_t header_bytes =
+      (sizeof(block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+  block* blocks_{nullptr};  // owned blocks, most recent first
+  std::byte* initial_buffer_{nullptr};
+  size_t initial_bytes_{0};
+  std::byte* cur_{nullptr};
+  std::byte* end_{nullptr};
+  std::byte* last_{nullptr};  // start of the most recent allocation, null if it can't be grown or rolled back
+  size_t next_block_bytes_;
+
+  void free_blocks(block* b) noexcept {
+    while (b) {
+      block* prev = b->prev;
+#ifdef __cpp_sized_deallocation
+      ::operator delete(b, b->bytes);
+#else
+      ::operator delete(b);
+#endif
+      b = prev;
+    }
+  }
+
+  void use(std::byte* first, const size_t bytes) noexcept {
+    cur_ = first;
+    end_ = first + bytes;
+    last_ = nullptr;
+  }
+
+  void new_block(const size_t bytes, const size_t align) {
+    const size_t needed = header_bytes + bytes + (align > alignof(std::max_align_t) ? align : 0);
+
+    if (needed < bytes) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    const size_t block_bytes = std::max(next_block_bytes_, needed);
+
+    block* b = static_cast<block*>(::operator new(block_bytes));
+    *b = block{blocks_, block_bytes};
+    blocks_ = b;
+
+    use(reinterpret_cast<std::byte*>(b) + header_bytes, block_bytes - header_bytes);
+    next_block_bytes_ = block_bytes <= std::numeric_limits<size_t>::max() / 2 ? block_bytes * 2 : block_bytes;
+  }
+
+  [[nodiscard]] std::byte* align_up(std::byte* p, const size_t align) const noexcept {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    return p + ((align - address % align) % align);
+  }
+
+ public:
+  // The first block taken from operator new is first_block_bytes large.
+  explicit monotonic_arena(const size_t first_block_bytes = default_block_bytes) noexcept
+      : next_block_bytes_{std::max(first_block_bytes, header_bytes + alignof(std::max_align_t))} {}
+
+  // Allocates from buffer first, e.g. an array on the stack. buffer isn't owned.
+  monotonic_arena(void* buffer, const size_t bytes, const size_t first_block_bytes = default_block_bytes) noexcept
+      : monotonic_arena(std::max(first_block_bytes, bytes * 2)) {
+    initial_buffer_ = static_cast<std::byte*>(buffer);
+    initial_bytes_ = bytes;
+    use(initial_buffer_, initial_bytes_);
+  }
+
+  monotonic_arena(const monotonic_arena&) = delete;
+  monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+  ~monotonic_arena() { free_blocks(blocks_); }
+
+  [[nodiscard]] void* allocate(const size_t bytes, const size_t align = alignof(std::max_align_t)) {
+    assert(std::has_single_bit(align));
+
+    std::byte* p = align_up(cur_, align);
+
+    if (cur_ == nullptr || p > end_ || static_cast<size_t>(end_ - p) < bytes) [[unlikely]] {
+      new_block(bytes, align);
+      p = align_up(cur_, align);
+    }
+
+    cur_ = p + bytes;
+    last_ = p;
+
+    return p;
+  }
+
+  // Grows the most recent allocation from old_bytes to new_bytes if the current block has room.
+  [[nodiscard]] bool expand_in_place(void* p, const size_t old_bytes, const size_t new_bytes) noexcept {
+    if (p != last_ || last_ + old_bytes != cur_ || static_cast<size_t>(end_ - last_) < new_bytes) {
+      return false;
+    }
+
+    cur_ = last_ + new_bytes;
+    return true;
+  }
+
+  // Only the most recent allocation is reclaimed, anything else waits for reset().
+  void deallocate(void* p, const size_t bytes) noexcept {
+    if (p != nullptr && p == last_ && last_ + bytes == cur_) {
+      cur_ = last_;
+      last_ = nullptr;
+    }
+  }
+
+  // Makes all the memory available again without giving it back, so the next round of allocations is served from
+  // the largest block. Everything allocated before is invalidated.
+  void reset() noexcept {
+    if (blocks_ == nullptr) {
+      if (initial_buffer_) {
+        use(initial_buffer_, initial_bytes_);
+      }
+
+      return;
+    }
+
+    free_blocks(std::exchange(blocks_->prev, nullptr));
+    use(reinterpret_cast<std::byte*>(blocks_) + header_bytes, blocks_->bytes - header_bytes);
+  }
+
+  // Bytes left in the current block.
+  [[nodiscard]] size_t remaining_bytes() const noexcept { return end_ - cur_; }
+
+};  // class monotonic_arena
+
+// ==================== arena_allocator ====================
+
+// Allocates from a monotonic_arena. It doesn't provide construct or destroy, so vector keeps its memcpy paths,
+// and it provides expand_in_place, so a vector on top of the arena grows without reallocating.
+template <class T>
+class arena_allocator {
+  template <class>
+  friend class arena_allocator;
+
+  monotonic_arena* arena_;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  arena_allocator(monotonic_arena& arena) noexcept : arena_{std::addressof(arena)} {}
+
+  template <class U>
+  arena_allocator(const arena_allocator<U>& other) noexcept : arena_{other.arena_} {}
+
+  [[nodiscard]] monotonic_arena& arena() const noexcept { return *arena_; }
+
+  [[nodiscard]] T* allocate(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, const size_type n) noexcept { arena_->deallocate(p, n * sizeof(T)); }
+
+  [[nodiscard]] bool expand_in_place(T* p, const size_type old_n, const size_type new_n) noexcept {
+    return new_n <= max_size() && arena_->expand_in_place(p, old_n * sizeof(T), new_n * sizeof(T));
+  }
+
+  [[nodiscard]] size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+  template <class U>
+  friend bool operator==(const arena_allocator& lhs, const arena_allocator<U>& rhs) noexcept {
+    return lhs.arena_ == rhs.arena_;
+  }
+
+};  // class arena_allocator
+
+template <class T>
+using arena_vector = vector<T, arena_allocator<T>>;
+
+}  // namespace v
+}  // namespace ciel
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== byte_buffer ====================
+
+// A byte buffer for parsers and IO, with the begin_cap/begin/end/end_cap layout of split_buffer:
+//
+//   [begin_cap, begin)  consumed bytes (front spare)
+//   [begin, end)        readable bytes
+//   [end, end_cap)      writable bytes (back spare)
+//
+// consume(n) from the front is O(1). The readable bytes are moved back to begin_cap only when the front spare
+// is at least as large as them (so each byte is moved at most once on average), or on reallocation.
+// Writers either append() bytes, or write into prepare(n) and then commit() what was written.
+template <class Allocator = std::allocator<std::byte>>
+class byte_buffer {
+  static_assert(std::is_same_v<typename Allocator::value_type, std::byte>);
+
+ public:
+  using value_type = std::byte;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+ private:
+  using alloc_traits = std::allocator_traits<allocator_type>;
+  using pointer = alloc_traits::pointer;
+
+  pointer begin_cap_{nullptr};
+  pointer begin_{nullptr};
+  pointer end_{nullptr};
+  pointer end_cap_{nullptr};
+  [[no_unique_address]] allocator_type alloc_;
+
+  void deallocate() noexcept {
+    if (begin_cap_) {
+      alloc_traits::deallocate(alloc_, begin_cap_, capacity());
+    }
+  }
+
+  // Moves the readable bytes to a new allocation of new_cap bytes.
+  void reallocate(const size_type new_cap) {
+    assert(new_cap >= size());
+
+    if (new_cap > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::length_error("ciel::byte_buffer capacity is beyond max_size"));
+    }
+
+    const size_type sz = size();
+    pointer new_begin = alloc_traits::allocate(alloc_, new_cap);
+
+    if (sz != 0) {
+      std::memcpy(std::to_address(new_begin), std::to_address(begin_), sz);
+    }
+
+    deallocate();
+    begin_cap_ = new_begin;
+    begin_ = new_begin;
+    end_ = new_begin + sz;
+    end_cap_ = new_begin + new_cap;
+  }
+
+ public:
+  byte_buffer() = default;
+
+  explicit byte_buffer(const allocator_type& alloc) noexcept : alloc_(alloc) {}
+
+  byte_buffer(reserve_capacity_t, const size_type count, const allocator_type& alloc = allocator_type())
+      : alloc_(alloc) {
+    if (count != 0) {
+      reallocate(count);
+    }
+  }
+
+  byte_buffer(const byte_buffer& other)
+      : alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+    append(other.readable());
+  }
+
+  byte_buffer(byte_buffer&& other) noexcept
+      : begin_cap_{std::exchange(other.begin_cap_, nullptr)},
+        begin_{std::exchange(other.begin_, nullptr)},
+        end_{std::exchange(other.end_, nullptr)},
+        end_cap_{std::exchange(other.end_cap_, nullptr)},
+        alloc_(std::move(other.alloc_)) {}
+
+  byte_buffer& operator=(const byte_buffer& other) {
+    if (this != std::addressof(other)) {
+      clear();
+      append(other.readable());
+    }
+
+    return *this;
+  }
+
+  byte_buffer& operator=(byte_buffer&& other) noexcept {
+    byte_buffer(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~byte_buffer() { deallocate(); }
+
+  allocator_type get_allocator() const noexcept { return alloc_; }
+
+  // ==================== read side ====================
+
+  [[nodiscard]] std::span<const std::byte> readable() const noexcept {
+    return std::span<const std::byte>(std::to_address(begin_), size());
+  }
+
+  [[nodiscard]] const std::byte* data() const noexcept { return std::to_address(begin_); }
+
+  [[nodiscard]] std::byte operator[](const size_type pos) const noexcept {
+    assert(pos < size());
+
+    return begin_[pos];
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return begin_ == end_; }
+
+  // Number of readable bytes.
+  [[nodiscard]] size_type size() const noexcept { return end_ - begin_; }
+
+  [[nodiscard]] size_type max_size() const noexcept {
+    return std::min<size_type>(std::numeric_limits<difference_type>::max(), alloc_traits::max_size(alloc_));
+  }
+
+  [[nodiscard]] size_type capacity() const noexcept { return end_cap_ - begin_cap_; }
+
+  // Consumed bytes before the readable ones.
+  [[nodiscard]] size_type front_spare() const noexcept { return begin_ - begin_cap_; }
+
+  // Writable bytes after the readable ones.
+  [[nodiscard]] size_type back_spare() const noexcept { return end_cap_ - end_; }
+
+  // Drops the first n readable bytes.
+  void consume(const size_type n) noexcept {
+    assert(n <= size());
+
+    begin_ += n;
+
+    if (begin_ == end_) {
+      // Compaction for free.
+      begin_ = begin_cap_;
+      end_ = begin_cap_;
+    }
+  }
+
+  // ==================== write side ====================
+
+  // Returns at least n writable bytes after the readable ones. Compacts when the consumed front is at least as
+  // large as the readable bytes and that makes enough room, reallocates otherwise.
+  [[nodiscard]] std::span<std::byte> prepare(const size_type n) {
+    if (back_spare() < n) {
+      if (front_spare() >= size() && front_spare() + back_spare() >= n) {
+        compact();
+
+      } else {
+        if (n > max_size() - size()) [[unlikely]] {
+          CIEL_THROW_EXCEPTION(std::length_error("ciel::byte_buffer::prepare size is beyond max_size"));
+        }
+
+        reallocate(std::max(capacity() * 2, size() + n));
+      }
+    }
+
+    return std::span<std::byte>(std::to_address(end_), back_spare());
+  }
+
+  // Makes the first n bytes of the last prepare() readable.
+  void commit(const size_type n) noexcept {
+    assert(n <= back_spare());
+
+    end_ += n;
+  }
+
+  void append(std::span<const std::byte> bytes) {
+    if (bytes.empty()) {
+      return;
+    }
+
+    // prepare() may compact or reallocate, which moves the readable bytes but keeps them relative to begin_.
+    const std::byte* first = std::to_address(begin_);
+    const bool internal = first <= bytes.data() && bytes.data() < std::to_address(end_);
+    const size_type internal_offset = internal ? bytes.data() - first : 0;
+
+    std::byte* dst = prepare(bytes.size()).data();
+    const std::byte* src = internal ? std::to_address(begin_) + internal_offset : bytes.data();
+
+    std::memcpy(dst, src, bytes.size());
+    commit(bytes.size());
+  }
+
+  void append(const void* src, const size_type n) { append(std::span(static_cast<const std::byte*>(src), n)); }
+
+  // ==================== capacity ====================
+
+  // Moves the readable bytes to the front of the buffer.
+  void compact() noexcept {
+    if (begin_ == begin_cap_) {
+      return;
+    }
+
+    const size_type sz = size();
+    if (sz != 0) {
+      std::memmove(std::to_address(begin_cap_), std::to_address(begin_), sz);
+    }
+
+    begin_ = begin_cap_;
+    end_ = begin_cap_ + sz;
+  }
+
+  // Makes room for at least n readable bytes in total without reallocation.
+  void reserve(const size_type n) {
+    if (n > capacity()) {
+      reallocate(n);
+    }
+  }
+
+  void shrink_to_fit() {
+    if (size() == capacity()) {
+      return;
+    }
+
+    if (empty()) {
+      deallocate();
+      begin_cap_ = begin_ = end_ = end_cap_ = nullptr;
+      return;
+    }
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      reallocate(size());
+#ifdef __cpp_exceptions
+    } catch (...) {
+    }
+#endif
+  }
+
+  void clear() noexcept {
+    begin_ = begin_cap_;
+    end_ = begin_cap_;
+  }
+
+  void swap(byte_buffer& other) noexcept {
+    using std::swap;
+
+    swap(begin_cap_, other.begin_cap_);
+    swap(begin_, other.begin_);
+    swap(end_, other.end_);
+    swap(end_cap_, other.end_cap_);
+    swap(alloc_, other.alloc_);
+  }
+
+};  // class byte_buffer
+
+template <class Allocator>
+struct is_trivially_relocatable<byte_buffer<Allocator>> : is_trivially_relocatable<Allocator> {};
+
+template <class Alloc>
+bool operator==(const byte_buffer<Alloc>& lhs, const byte_buffer<Alloc>& rhs) noexcept {
+  return std::ranges::equal(lhs.readable(), rhs.readable());
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class Alloc>
+void swap(ciel::byte_buffer<Alloc>& lhs, ciel::byte_buffer<Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
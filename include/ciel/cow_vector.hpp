@@ -0,0 +1,392 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== cow_vector ====================
+
+// A copy-on-write vector. Copies share one reference counted buffer, which is cloned lazily
+// on the first modifying call. Read access never clones, so only const accessors are provided,
+// and elements are modified in place with set(). The underlying vector is never handed out, since a
+// reference to it would keep writing into a buffer shared by later copies.
+template <class T, class Allocator = std::allocator<T>>
+class cow_vector {
+ public:
+  using vector_type = vector<T, Allocator>;
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = vector_type::size_type;
+  using difference_type = vector_type::difference_type;
+  using reference = vector_type::const_reference;
+  using const_reference = vector_type::const_reference;
+  using pointer = vector_type::const_pointer;
+  using const_pointer = vector_type::const_pointer;
+  using iterator = vector_type::const_iterator;
+  using const_iterator = vector_type::const_iterator;
+  using reverse_iterator = vector_type::const_reverse_iterator;
+  using const_reverse_iterator = vector_type::const_reverse_iterator;
+
+ private:
+  struct rep {
+    std::atomic<size_t> refcount{1};
+    vector_type vec;
+
+    template <class... Args>
+    explicit rep(Args&&... args) : vec(std::forward<Args>(args)...) {}
+  };
+
+  using rep_allocator = std::allocator_traits<allocator_type>::template rebind_alloc<rep>;
+  using rep_traits = std::allocator_traits<rep_allocator>;
+
+  rep* rep_{nullptr};
+  [[no_unique_address]] allocator_type alloc_;
+
+  template <class... Args>
+  [[nodiscard]] rep* make_rep(Args&&... args) {
+    rep_allocator ra(alloc_);
+    const auto p = rep_traits::allocate(ra, 1);
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      rep_traits::construct(ra, std::to_address(p), std::forward<Args>(args)...);
+#ifdef __cpp_exceptions
+    } catch (...) {
+      rep_traits::deallocate(ra, p, 1);
+      throw;
+    }
+#endif
+
+    return std::to_address(p);
+  }
+
+  void release() noexcept {
+    if (rep_ && rep_->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      rep_allocator ra(alloc_);
+      rep_traits::destroy(ra, rep_);
+      rep_traits::deallocate(ra, std::pointer_traits<typename rep_traits::pointer>::pointer_to(*rep_), 1);
+    }
+
+    rep_ = nullptr;
+  }
+
+  [[nodiscard]] bool shared() const noexcept {
+    return rep_ && rep_->refcount.load(std::memory_order_acquire) != 1;
+  }
+
+  // Drops the current buffer without cloning it when it's shared.
+  vector_type& mutate_discard() {
+    if (rep_ == nullptr || shared()) {
+      rep* r = make_rep(alloc_);
+      release();
+      rep_ = r;
+    }
+
+    return rep_->vec;
+  }
+
+  // Returns the underlying vector, cloning the shared buffer first if needed. extra is the number of
+  // elements the caller is going to add, so that the clone can reserve for them up front.
+  vector_type& mutate(const size_type extra = 0) {
+    if (rep_ == nullptr) {
+      rep_ = make_rep(alloc_);
+
+    } else if (shared()) {
+      const vector_type& src = rep_->vec;
+      const size_type cap = std::max(src.capacity(), src.size() + extra);
+
+      // The clone is built before the rep, so a throwing copy frees it. Enough capacity is reserved, so this
+      // goes straight to uninitialized_copy, which is a single memcpy for trivially copyable types.
+      vector_type clone = cap == 0 ? vector_type(alloc_) : vector_type(reserve_capacity, cap, alloc_);
+      clone.insert(clone.end(), src.begin(), src.end());
+
+      rep* r = make_rep(std::move(clone));
+      release();
+      rep_ = r;
+    }
+
+    return rep_->vec;
+  }
+
+ public:
+  cow_vector() = default;
+
+  explicit cow_vector(const allocator_type& alloc) noexcept(std::is_nothrow_copy_constructible_v<allocator_type>)
+      : alloc_(alloc) {}
+
+  explicit cow_vector(const size_type count, const allocator_type& alloc = allocator_type()) : cow_vector(alloc) {
+    if (count > 0) {
+      rep_ = make_rep(count, alloc_);
+    }
+  }
+
+  cow_vector(const size_type count, const value_type& value, const allocator_type& alloc = allocator_type())
+      : cow_vector(alloc) {
+    if (count > 0) {
+      rep_ = make_rep(count, value, alloc_);
+    }
+  }
+
+  template <std::input_iterator Iter>
+  cow_vector(Iter first, Iter last, const allocator_type& alloc = allocator_type()) : cow_vector(alloc) {
+    if (first != last) {
+      rep_ = make_rep(first, last, alloc_);
+    }
+  }
+
+  cow_vector(std::initializer_list<value_type> init, const allocator_type& alloc = allocator_type())
+      : cow_vector(init.begin(), init.end(), alloc) {}
+
+  // Takes over the buffer of other without copying.
+  explicit cow_vector(vector_type&& other) : alloc_(other.get_allocator()) {
+    if (!other.empty()) {
+      rep_ = make_rep(std::move(other));
+    }
+  }
+
+  cow_vector(const cow_vector& other) noexcept : rep_(other.rep_), alloc_(other.alloc_) {
+    if (rep_) {
+      rep_->refcount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  cow_vector(cow_vector&& other) noexcept : rep_(std::exchange(other.rep_, nullptr)), alloc_(other.alloc_) {}
+
+  ~cow_vector() { release(); }
+
+  cow_vector& operator=(const cow_vector& other) noexcept {
+    cow_vector(other).swap(*this);
+    return *this;
+  }
+
+  cow_vector& operator=(cow_vector&& other) noexcept {
+    cow_vector(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  cow_vector& operator=(std::initializer_list<value_type> ilist) {
+    assign(ilist);
+    return *this;
+  }
+
+  void assign(const size_type count, const value_type& value) { mutate_discard().assign(count, value); }
+
+  template <std::input_iterator Iter>
+  void assign(Iter first, Iter last) {
+    mutate_discard().assign(first, last);
+  }
+
+  void assign(std::initializer_list<value_type> ilist) { mutate_discard().assign(ilist); }
+
+  allocator_type get_allocator() const noexcept { return alloc_; }
+
+  [[nodiscard]] size_type use_count() const noexcept {
+    return rep_ ? rep_->refcount.load(std::memory_order_relaxed) : 0;
+  }
+
+  [[nodiscard]] const_reference at(const size_type pos) const {
+    if (pos >= size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::cow_vector::at pos is not within the range"));
+    }
+
+    return rep_->vec[pos];
+  }
+
+  [[nodiscard]] const_reference operator[](const size_type pos) const {
+    assert(pos < size());
+
+    return rep_->vec[pos];
+  }
+
+  [[nodiscard]] const_reference front() const {
+    assert(!empty());
+
+    return rep_->vec.front();
+  }
+
+  [[nodiscard]] const_reference back() const {
+    assert(!empty());
+
+    return rep_->vec.back();
+  }
+
+  [[nodiscard]] const T* data() const noexcept { return rep_ ? rep_->vec.data() : nullptr; }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return rep_ ? rep_->vec.begin() : const_iterator{}; }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] const_iterator end() const noexcept { return rep_ ? rep_->vec.end() : const_iterator{}; }
+
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+  [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+
+  [[nodiscard]] const_reverse_iterator crend() const noexcept { return rend(); }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  [[nodiscard]] size_type size() const noexcept { return rep_ ? rep_->vec.size() : 0; }
+
+  [[nodiscard]] size_type max_size() const noexcept { return vector_type(alloc_).max_size(); }
+
+  [[nodiscard]] size_type capacity() const noexcept { return rep_ ? rep_->vec.capacity() : 0; }
+
+  void reserve(const size_type new_cap) {
+    if (new_cap > capacity()) {
+      mutate(new_cap - size()).reserve(new_cap);
+    }
+  }
+
+  void shrink_to_fit() {
+    if (!shared() && rep_) {
+      rep_->vec.shrink_to_fit();
+    }
+  }
+
+  // Shared buffers are left to other owners rather than being cloned and then cleared.
+  void clear() noexcept {
+    if (shared()) {
+      release();
+
+    } else if (rep_) {
+      rep_->vec.clear();
+    }
+  }
+
+  template <class U>
+  void set(const size_type pos, U&& value) {
+    assert(pos < size());
+
+    mutate()[pos] = std::forward<U>(value);
+  }
+
+  iterator insert(const_iterator pos, const value_type& value) { return insert(pos, 1, value); }
+
+  iterator insert(const_iterator pos, value_type&& value) {
+    const size_type index = pos - begin();
+    vector_type& vec = mutate(1);
+    return vec.insert(vec.begin() + index, std::move(value));
+  }
+
+  iterator insert(const_iterator pos, const size_type count, const value_type& value) {
+    const size_type index = pos - begin();
+    vector_type& vec = mutate(count);
+    return vec.insert(vec.begin() + index, count, value);
+  }
+
+  template <std::input_iterator Iter>
+  iterator insert(const_iterator pos, Iter first, Iter last) {
+    const size_type index = pos - begin();
+    size_type extra = 0;
+    if constexpr (std::forward_iterator<Iter>) {
+      extra = std::distance(first, last);
+    }
+
+    vector_type& vec = mutate(extra);
+    return vec.insert(vec.begin() + index, first, last);
+  }
+
+  iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    const size_type index = pos - begin();
+    vector_type& vec = mutate(1);
+    return vec.emplace(vec.begin() + index, std::forward<Args>(args)...);
+  }
+
+  iterator erase(const_iterator pos) {
+    const size_type index = pos - begin();
+    vector_type& vec = mutate();
+    return vec.erase(vec.begin() + index);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    const size_type index = first - begin();
+    const size_type count = last - first;
+    vector_type& vec = mutate();
+    return vec.erase(vec.begin() + index, vec.begin() + index + count);
+  }
+
+  void push_back(const value_type& value) { mutate(1).push_back(value); }
+
+  void push_back(value_type&& value) { mutate(1).push_back(std::move(value)); }
+
+  template <class... Args>
+  const_reference emplace_back(Args&&... args) {
+    return mutate(1).emplace_back(std::forward<Args>(args)...);
+  }
+
+  void pop_back() {
+    assert(!empty());
+
+    mutate().pop_back();
+  }
+
+  void resize(const size_type count) {
+    if (count != size()) {
+      mutate(count > size() ? count - size() : 0).resize(count);
+    }
+  }
+
+  void resize(const size_type count, const value_type& value) {
+    if (count != size()) {
+      mutate(count > size() ? count - size() : 0).resize(count, value);
+    }
+  }
+
+  void swap(cow_vector& other) noexcept {
+    using std::swap;
+
+    swap(rep_, other.rep_);
+    swap(alloc_, other.alloc_);
+  }
+
+};  // class cow_vector
+
+template <class T, class Allocator>
+struct is_trivially_relocatable<cow_vector<T, Allocator>> : is_trivially_relocatable<Allocator> {};
+
+template <class T, class Alloc>
+bool operator==(const cow_vector<T, Alloc>& lhs, const cow_vector<T, Alloc>& rhs) {
+  return lhs.size() == rhs.size() && (lhs.data() == rhs.data() || std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+}
+
+template <class T, class Alloc>
+ciel::v::synth_three_way_result<T> operator<=>(const cow_vector<T, Alloc>& lhs, const cow_vector<T, Alloc>& rhs) {
+  return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                ciel::v::synth_three_way);
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class T, class Alloc>
+void swap(ciel::cow_vector<T, Alloc>& lhs, ciel::cow_vector<T, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
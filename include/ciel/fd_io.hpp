@@ -0,0 +1,150 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== fd_io ====================
+
+// POSIX file descriptor IO on vectors of trivially copyable elements. Reads go straight into the spare
+// capacity, so no intermediate buffer is used and the bytes to be overwritten are never value-initialized.
+// Like read/write, functions return -1 and leave errno set on failure. EINTR is retried.
+
+struct fd_io_impl {
+  template <class T, class Allocator>
+  static constexpr bool readable =
+      sizeof(T) == 1 && std::is_trivially_copyable_v<T> &&
+      allocator_has_trivial_construct<Allocator, T*>::value && allocator_has_trivial_destroy<Allocator, T*>::value;
+
+  template <class T, class Allocator>
+  static ssize_t read_into_spare(vector<T, Allocator>& v, const int fd) noexcept {
+    ssize_t n;
+    do {
+      n = ::read(fd, std::to_address(v.data()) + v.size(), v.capacity() - v.size());
+    } while (n < 0 && errno == EINTR);
+
+    if (n > 0) {
+      // Bytes are implicit-lifetime types, the read created them.
+      v.unchecked_set_size(v.size() + n);
+    }
+
+    return n;
+  }
+
+};  // struct fd_io_impl
+
+// Reads once from fd into v's spare capacity, after growing it via reserve_spare if less than min_spare bytes
+// are left. Returns the number of bytes appended, 0 at end of file.
+template <class T, class Allocator>
+ssize_t append_from_fd(vector<T, Allocator>& v, const int fd, const size_t min_spare = 4096) {
+  static_assert(fd_io_impl::readable<T, Allocator>, "append_from_fd needs a vector of trivial bytes.");
+  assert(min_spare != 0);
+
+  v.reserve_spare(min_spare);
+  return fd_io_impl::read_into_spare(v, fd);
+}
+
+// Reads from fd until end of file. Returns the number of bytes appended.
+template <class T, class Allocator>
+ssize_t append_all_from_fd(vector<T, Allocator>& v, const int fd, const size_t min_spare = 4096) {
+  static_assert(fd_io_impl::readable<T, Allocator>, "append_all_from_fd needs a vector of trivial bytes.");
+
+  ssize_t total = 0;
+
+  while (true) {
+    const ssize_t n = append_from_fd(v, fd, min_spare);
+
+    if (n < 0) {
+      return -1;
+    }
+
+    if (n == 0) {
+      return total;
+    }
+
+    total += n;
+  }
+}
+
+// Writes iov[0, count) completely, resuming after partial writes. The iovecs are modified.
+inline ssize_t writev_all(const int fd, iovec* iov, int count) noexcept {
+  ssize_t total = 0;
+
+  while (count > 0 && iov->iov_len == 0) {
+    ++iov;
+    --count;
+  }
+
+  while (count > 0) {
+    const ssize_t n = ::writev(fd, iov, std::min(count, IOV_MAX));
+
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return -1;
+    }
+
+    total += n;
+
+    // Drops the fully written iovecs, including empty ones, then trims the partially written one.
+    size_t left = static_cast<size_t>(n);
+    while (count > 0 && left >= iov->iov_len) {
+      left -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+      iov->iov_len -= left;
+    }
+  }
+
+  return total;
+}
+
+// Writes all elements of v, resuming after partial writes. Returns the number of bytes written.
+template <class T, class Allocator>
+ssize_t write_to_fd(const int fd, const vector<T, Allocator>& v) noexcept {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  iovec iov{const_cast<T*>(v.data()), v.size() * sizeof(T)};
+  return writev_all(fd, &iov, 1);
+}
+
+// Writes all elements of all vectors in order with writev, resuming after partial writes.
+// Returns the number of bytes written.
+template <class T, class Allocator>
+ssize_t write_to_fd(const int fd, std::span<const vector<T, Allocator>> vs) {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  vector<iovec> iovs(reserve_capacity, std::max<size_t>(vs.size(), 1));
+  for (const auto& v : vs) {
+    iovs.unchecked_emplace_back(const_cast<T*>(v.data()), v.size() * sizeof(T));
+  }
+
+  return writev_all(fd, iovs.data(), static_cast<int>(std::min<size_t>(iovs.size(), INT_MAX)));
+}
+
+}  // namespace v
+}  // namespace ciel
+
+#endif
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== heap_queue ====================
+
+// A d-ary heap based priority queue on top of vector. Like std::priority_queue, top() is the greatest
+// element according to Compare.
+//
+// Sifting moves a hole instead of swapping elements: the sifted element is taken out once, each level
+// costs one move of a parent/child into the hole, and the element is put back at the final hole.
+// When vector can relocate via memmove, taking out and moving are raw memcpys of sizeof(T) bytes.
+template <class T, size_t Arity = 2, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+class heap_queue {
+  static_assert(Arity >= 2, "heap_queue needs at least 2 children per node.");
+
+ public:
+  using container_type = vector<T, Allocator>;
+  using value_compare = Compare;
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = container_type::size_type;
+  using reference = container_type::reference;
+  using const_reference = container_type::const_reference;
+
+ private:
+  container_type c_;
+  [[no_unique_address]] value_compare comp_;
+
+  static constexpr bool via_memcpy = container_type::move_via_memmove;
+
+  // Bytes of an element taken out of the heap. They are put into the hole on destruction,
+  // so the heap never loses or duplicates an element even if Compare throws.
+  class relocated_value {
+   private:
+    alignas(value_type) unsigned char bytes_[sizeof(value_type)];
+    value_type* base_;
+    const size_type& hole_;
+
+   public:
+    relocated_value(value_type* src, value_type* base, const size_type& hole) noexcept : base_{base}, hole_{hole} {
+      std::memcpy(static_cast<void*>(bytes_), static_cast<const void*>(src), sizeof(value_type));
+    }
+
+    relocated_value(const relocated_value&) = delete;
+    relocated_value& operator=(const relocated_value&) = delete;
+
+    ~relocated_value() {
+      std::memcpy(static_cast<void*>(base_ + hole_), static_cast<const void*>(bytes_), sizeof(value_type));
+    }
+
+    [[nodiscard]] const value_type& get() const noexcept {
+      return *std::launder(reinterpret_cast<const value_type*>(bytes_));
+    }
+
+  };  // class relocated_value
+
+  static void move_into_hole(value_type* base, const size_type hole, const size_type from) noexcept(via_memcpy) {
+    if constexpr (via_memcpy) {
+      std::memcpy(static_cast<void*>(base + hole), static_cast<const void*>(base + from), sizeof(value_type));
+
+    } else {
+      base[hole] = std::move(base[from]);
+    }
+  }
+
+  // The counterpart of relocated_value when elements are moved: value has been moved out of the heap, and is
+  // moved into the final hole once sift is done, or into the current one if sift throws.
+  template <class Sift>
+  static void sift_held_value(value_type* base, const size_type& hole, value_type& value, Sift&& sift) {
+#ifdef __cpp_exceptions
+    try {
+#endif
+      sift();
+#ifdef __cpp_exceptions
+    } catch (...) {
+      base[hole] = std::move(value);
+      throw;
+    }
+#endif
+
+    base[hole] = std::move(value);
+  }
+
+  // Moves the hole up until value fits. The hole's final position is left in hole.
+  void sift_up_hole(value_type* base, size_type& hole, const value_type& value) {
+    while (hole > 0) {
+      const size_type parent = (hole - 1) / Arity;
+      if (!comp_(base[parent], value)) {
+        break;
+      }
+
+      move_into_hole(base, hole, parent);
+      hole = parent;
+    }
+  }
+
+  // Moves the hole down until value fits among the first n elements. The hole's final position is left in hole.
+  void sift_down_hole(value_type* base, const size_type n, size_type& hole, const value_type& value) {
+    while (true) {
+      const size_type first_child = hole * Arity + 1;
+      if (first_child >= n) {
+        break;
+      }
+
+      const size_type last_child = std::min(first_child + Arity, n);
+      size_type best = first_child;
+      for (size_type c = first_child + 1; c < last_child; ++c) {
+        if (comp_(base[best], base[c])) {
+          best = c;
+        }
+      }
+
+      if (!comp_(value, base[best])) {
+        break;
+      }
+
+      move_into_hole(base, hole, best);
+      hole = best;
+    }
+  }
+
+  void sift_up(const size_type index) {
+    value_type* base = c_.data();
+    size_type hole = index;
+
+    if constexpr (via_memcpy) {
+      const relocated_value value(base + index, base, hole);
+      sift_up_hole(base, hole, value.get());
+
+    } else {
+      value_type value = std::move(base[index]);
+      sift_held_value(base, hole, value, [&] { sift_up_hole(base, hole, value); });
+    }
+  }
+
+  void sift_down(const size_type index, const size_type n) {
+    value_type* base = c_.data();
+    size_type hole = index;
+
+    if constexpr (via_memcpy) {
+      const relocated_value value(base + index, base, hole);
+      sift_down_hole(base, n, hole, value.get());
+
+    } else {
+      value_type value = std::move(base[index]);
+      sift_held_value(base, hole, value, [&] { sift_down_hole(base, n, hole, value); });
+    }
+  }
+
+  // Floyd's bottom-up heap construction, O(n).
+  void make_heap() {
+    const size_type n = size();
+    if (n < 2) {
+      return;
+    }
+
+    for (size_type i = (n - 2) / Arity + 1; i != 0;) {
+      --i;
+      sift_down(i, n);
+    }
+  }
+
+  // Restores the heap after elements [old_size, size()) have been appended.
+  void heapify_appended(const size_type old_size) {
+    const size_type n = size();
+    const size_type k = n - old_size;
+
+    // Sifting up each new element costs about k * depth, rebuilding costs about n.
+    size_type depth = 0;
+    for (size_type m = n; m > 0; m /= Arity) {
+      ++depth;
+    }
+
+    if (k * depth < n) {
+      for (size_type i = old_size; i < n; ++i) {
+        sift_up(i);
+      }
+
+    } else {
+      make_heap();
+    }
+  }
+
+  // Removes the top element, calling top_handler on it first. With via_memcpy, top_handler must consume the
+  // top element (destroy or relocate it).
+  template <class TopHandler>
+  void pop_impl(TopHandler&& top_handler) {
+    assert(!empty());
+
+    value_type* base = c_.data();
+    const size_type n = size() - 1;
+
+    if constexpr (via_memcpy) {
+      top_handler(base);
+
+      if (n == 0) {
+        c_.unchecked_set_size(0);
+        return;
+      }
+
+      size_type hole = 0;
+      const relocated_value value(base + n, base, hole);
+      c_.unchecked_set_size(n);
+      sift_down_hole(base, n, hole, value.get());
+
+    } else {
+      top_handler(base);
+
+      if (n == 0) {
+        c_.pop_back();
+        return;
+      }
+
+      value_type value = std::move(base[n]);
+      c_.pop_back();
+
+      size_type hole = 0;
+      sift_held_value(base, hole, value, [&] { sift_down_hole(base, n, hole, value); });
+    }
+  }
+
+ public:
+  heap_queue() = default;
+
+  explicit heap_queue(const value_compare& comp, const allocator_type& alloc = allocator_type())
+      : c_(alloc), comp_(comp) {}
+
+  explicit heap_queue(container_type&& c, const value_compare& comp = value_compare())
+      : c_(std::move(c)), comp_(comp) {
+    make_heap();
+  }
+
+  template <std::input_iterator Iter>
+  heap_queue(Iter first, Iter last, const value_compare& comp = value_compare(),
+             const allocator_type& alloc = allocator_type())
+      : c_(first, last, alloc), comp_(comp) {
+    make_heap();
+  }
+
+  heap_queue(std::initializer_list<value_type> ilist, const value_compare& comp = value_compare(),
+             const allocator_type& alloc = allocator_type())
+      : heap_queue(ilist.begin(), ilist.end(), comp, alloc) {}
+
+  [[nodiscard]] const_reference top() const {
+    assert(!empty());
+
+    return c_.front();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return c_.empty(); }
+
+  [[nodiscard]] size_type size() const noexcept { return c_.size(); }
+
+  [[nodiscard]] size_type capacity() const noexcept { return c_.capacity(); }
+
+  [[nodiscard]] const container_type& container() const noexcept { return c_; }
+
+  [[nodiscard]] value_compare value_comp() const { return comp_; }
+
+  void reserve(const size_type new_cap) { c_.reserve(new_cap); }
+
+  void clear() noexcept { c_.clear(); }
+
+  void push(const value_type& value) {
+    c_.push_back(value);
+    sift_up(size() - 1);
+  }
+
+  void push(value_type&& value) {
+    c_.push_back(std::move(value));
+    sift_up(size() - 1);
+  }
+
+  template <class... Args>
+  void emplace(Args&&... args) {
+    c_.emplace_back(std::forward<Args>(args)...);
+    sift_up(size() - 1);
+  }
+
+  // Appends [first, last) and restores the heap, either by sifting up the new elements
+  // or by an O(n) rebuild, whichever is cheaper.
+  template <std::input_iterator Iter>
+  void push_bulk(Iter first, Iter last) {
+    const size_type old_size = size();
+    c_.insert(c_.end(), first, last);
+    heapify_appended(old_size);
+  }
+
+  void push_bulk(std::initializer_list<value_type> ilist) { push_bulk(ilist.begin(), ilist.end()); }
+
+  void pop() {
+    pop_impl([&](value_type* p) {
+      if constexpr (via_memcpy) {
+        allocator_type alloc = c_.get_allocator();
+        std::allocator_traits<allocator_type>::destroy(alloc, p);
+      }
+    });
+  }
+
+  // Removes and returns the top element.
+  [[nodiscard]] value_type pop_value() {
+    value_type res = std::move(c_.front());
+    pop();
+    return res;
+  }
+
+  // Removes the top element and appends it to out. When both vectors can relocate via memmove,
+  // the element is relocated with a memcpy rather than moved and destroyed.
+  template <class Alloc>
+  void pop_into(vector<value_type, Alloc>& out) {
+    assert(!empty());
+
+    if constexpr (via_memcpy && vector<value_type, Alloc>::move_via_memmove) {
+      out.reserve_spare(1);
+
+      pop_impl([&](value_type* p) {
+        const auto size = out.size();
+        std::memcpy(static_cast<void*>(std::to_address(out.data()) + size), static_cast<const void*>(p),
+                    sizeof(value_type));
+        out.unchecked_set_size(size + 1);
+      });
+
+    } else {
+      out.emplace_back(std::move(c_.front()));
+      pop();
+    }
+  }
+
+  void swap(heap_queue& other) noexcept(std::is_nothrow_swappable_v<value_compare>) {
+    using std::swap;
+
+    c_.swap(other.c_);
+    swap(comp_, other.comp_);
+  }
+
+};  // class heap_queue
+
+template <class T, size_t Arity, class Compare, class Allocator>
+struct is_trivially_relocatable<heap_queue<T, Arity, Compare, Allocator>>
+    : std::conjunction<is_trivially_relocatable<vector<T, Allocator>>, is_trivially_relocatable<Compare>> {};
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class T, size_t Arity, class Compare, class Alloc>
+void swap(ciel::heap_queue<T, Arity, Compare, Alloc>& lhs,
+          ciel::heap_queue<T, Arity, Compare, Alloc>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
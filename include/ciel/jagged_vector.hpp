@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== jagged_vector ====================
+
+// A vector of variable length rows in compressed sparse row (CSR) layout: the elements of all rows are
+// stored contiguously in one values vector, and row i spans [offsets[i], offsets[i + 1]).
+// Compared to vector<vector<T>>, there is no allocation and no begin/end/cap triple per row.
+//
+// Offset can be narrowed (e.g. uint32_t) to halve the per-row overhead when the total number of
+// elements fits.
+template <class T, class Offset = size_t, class Allocator = std::allocator<T>>
+class jagged_vector {
+  static_assert(std::is_unsigned_v<Offset>);
+
+ public:
+  using value_type = T;
+  using offset_type = Offset;
+  using allocator_type = Allocator;
+  using values_type = vector<value_type, allocator_type>;
+  using offsets_type =
+      vector<offset_type, typename std::allocator_traits<allocator_type>::template rebind_alloc<offset_type>>;
+  using size_type = values_type::size_type;
+  using difference_type = values_type::difference_type;
+  using row_type = std::span<value_type>;
+  using const_row_type = std::span<const value_type>;
+
+  template <bool Const>
+  class row_iterator;
+
+  using iterator = row_iterator<false>;
+  using const_iterator = row_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+ private:
+  offsets_type offsets_;  // offsets_.size() == rows() + 1 once anything has been pushed.
+  values_type values_;
+
+  static constexpr size_type max_offset = std::numeric_limits<offset_type>::max();
+
+  void check_offset(const size_type new_values_size) const {
+    if (new_values_size > max_offset) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::length_error("ciel::jagged_vector total size is beyond offset_type's range"));
+    }
+  }
+
+  void ensure_leading_offset() {
+    if (offsets_.empty()) {
+      offsets_.emplace_back(0);
+    }
+  }
+
+  // Rolls back values_ to the last committed offset for exception handling.
+  struct values_guard {
+    values_type& values;
+    size_type size;
+
+    ~values_guard() {
+      if (values.size() > size) {
+        values.erase(values.begin() + size, values.end());
+      }
+    }
+  };
+
+  // r may refer to elements of values_ (e.g. a row of *this), so nothing is reserved by hand: vector::insert
+  // and emplace_back construct the new elements before they release the old buffer.
+  template <class R>
+  void append_values(R&& r) {
+    if constexpr (std::ranges::sized_range<R>) {
+      check_offset(values_.size() + std::ranges::size(r));
+    }
+
+    if constexpr (std::ranges::forward_range<R>) {
+      const auto first = std::ranges::begin(r);
+      values_.insert(values_.end(), first, std::ranges::next(first, std::ranges::end(r)));
+
+    } else {
+      for (auto&& e : r) {
+        values_.emplace_back(std::forward<decltype(e)>(e));
+      }
+    }
+
+    check_offset(values_.size());
+  }
+
+ public:
+  jagged_vector() = default;
+
+  explicit jagged_vector(const allocator_type& alloc) : offsets_(alloc), values_(alloc) {}
+
+  // Converts from a range of ranges (e.g. vector<vector<T>>). Row sizes are summed up front, so values are
+  // copied in a single pass into one allocation when the inner ranges are sized.
+  template <std::ranges::input_range R>
+    requires(!std::same_as<std::remove_cvref_t<R>, jagged_vector>) &&
+            std::ranges::input_range<std::ranges::range_reference_t<R>> &&
+            std::constructible_from<value_type, std::ranges::range_reference_t<std::ranges::range_reference_t<R>>>
+  explicit jagged_vector(R&& nested, const allocator_type& alloc = allocator_type()) : jagged_vector(alloc) {
+    using inner = std::ranges::range_reference_t<R>;
+
+    if constexpr (std::ranges::forward_range<R> && std::ranges::sized_range<inner>) {
+      size_type rows = 0;
+      size_type total = 0;
+
+      for (auto&& r : nested) {
+        ++rows;
+        total += std::ranges::size(r);
+      }
+
+      check_offset(total);
+      reserve(rows, total);
+    }
+
+    for (auto&& r : nested) {
+      push_row(r);
+    }
+  }
+
+  jagged_vector(std::initializer_list<std::initializer_list<value_type>> ilist,
+                const allocator_type& alloc = allocator_type())
+      : jagged_vector(std::views::all(ilist), alloc) {}
+
+  allocator_type get_allocator() const noexcept { return values_.get_allocator(); }
+
+  [[nodiscard]] row_type operator[](const size_type pos) noexcept {
+    assert(pos < rows());
+
+    return row_type(values_.data() + offsets_[pos], values_.data() + offsets_[pos + 1]);
+  }
+
+  [[nodiscard]] const_row_type operator[](const size_type pos) const noexcept {
+    assert(pos < rows());
+
+    return const_row_type(values_.data() + offsets_[pos], values_.data() + offsets_[pos + 1]);
+  }
+
+  [[nodiscard]] row_type row(const size_type pos) {
+    if (pos >= rows()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::jagged_vector::row pos is not within the range"));
+    }
+
+    return (*this)[pos];
+  }
+
+  [[nodiscard]] const_row_type row(const size_type pos) const {
+    if (pos >= rows()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::jagged_vector::row pos is not within the range"));
+    }
+
+    return (*this)[pos];
+  }
+
+  [[nodiscard]] row_type front() noexcept { return (*this)[0]; }
+
+  [[nodiscard]] const_row_type front() const noexcept { return (*this)[0]; }
+
+  [[nodiscard]] row_type back() noexcept { return (*this)[rows() - 1]; }
+
+  [[nodiscard]] const_row_type back() const noexcept { return (*this)[rows() - 1]; }
+
+  [[nodiscard]] size_type row_size(const size_type pos) const noexcept {
+    assert(pos < rows());
+
+    return offsets_[pos + 1] - offsets_[pos];
+  }
+
+  // All elements of all rows.
+  [[nodiscard]] std::span<value_type> values() noexcept { return {values_.data(), values_.size()}; }
+
+  [[nodiscard]] std::span<const value_type> values() const noexcept { return {values_.data(), values_.size()}; }
+
+  [[nodiscard]] std::span<const offset_type> offsets() const noexcept { return {offsets_.data(), offsets_.size()}; }
+
+  [[nodiscard]] iterator begin() noexcept { return iterator(this, 0); }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(this, 0); }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] iterator end() noexcept { return iterator(this, rows()); }
+
+  [[nodiscard]] const_iterator end() const noexcept { return const_iterator(this, rows()); }
+
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+  [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+
+  [[nodiscard]] bool empty() const noexcept { return rows() == 0; }
+
+  [[nodiscard]] size_type rows() const noexcept { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+  [[nodiscard]] size_type size() const noexcept { return rows(); }
+
+  [[nodiscard]] size_type values_size() const noexcept { return values_.size(); }
+
+  void reserve(const size_type new_rows, const size_type new_values) {
+    offsets_.reserve(new_rows + 1);
+    values_.reserve(new_values);
+  }
+
+  void shrink_to_fit() {
+    offsets_.shrink_to_fit();
+    values_.shrink_to_fit();
+  }
+
+  void clear() noexcept {
+    offsets_.clear();
+    values_.clear();
+  }
+
+  void push_row() {
+    ensure_leading_offset();
+    offsets_.emplace_back(offsets_.back());
+  }
+
+  template <std::ranges::input_range R>
+    requires std::constructible_from<value_type, std::ranges::range_reference_t<R>>
+  void push_row(R&& r) {
+    ensure_leading_offset();
+    offsets_.reserve_spare(1);  // so that the emplace_back below can't throw
+
+    values_guard guard{values_, values_.size()};
+    append_values(std::forward<R>(r));
+    offsets_.emplace_back(static_cast<offset_type>(values_.size()));
+    guard.size = values_.size();
+  }
+
+  void push_row(std::initializer_list<value_type> ilist) { push_row(std::views::all(ilist)); }
+
+  void pop_row() noexcept {
+    assert(!empty());
+
+    offsets_.pop_back();
+    values_.erase(values_.begin() + offsets_.back(), values_.end());
+
+    if (offsets_.size() == 1) {
+      offsets_.clear();
+    }
+  }
+
+  template <class... Args>
+  value_type& emplace_back_to_last_row(Args&&... args) {
+    assert(!empty());
+
+    check_offset(values_.size() + 1);
+    value_type& res = values_.emplace_back(std::forward<Args>(args)...);
+    ++offsets_.back();
+
+    return res;
+  }
+
+  void push_back_to_last_row(const value_type& value) { emplace_back_to_last_row(value); }
+
+  void push_back_to_last_row(value_type&& value) { emplace_back_to_last_row(std::move(value)); }
+
+  template <std::ranges::input_range R>
+    requires std::constructible_from<value_type, std::ranges::range_reference_t<R>>
+  void append_to_last_row(R&& r) {
+    assert(!empty());
+
+    values_guard guard{values_, values_.size()};
+    append_values(std::forward<R>(r));
+    offsets_.back() = static_cast<offset_type>(values_.size());
+    guard.size = values_.size();
+  }
+
+  void swap(jagged_vector& other) noexcept {
+    offsets_.swap(other.offsets_);
+    values_.swap(other.values_);
+  }
+
+  // ==================== row_iterator ====================
+
+  template <bool Const>
+  class row_iterator {
+   public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;  // operator* returns by value
+    using value_type = std::conditional_t<Const, const_row_type, row_type>;
+    using difference_type = ptrdiff_t;
+    using reference = value_type;
+
+   private:
+    using container = std::conditional_t<Const, const jagged_vector, jagged_vector>;
+
+    container* c_{nullptr};
+    size_type index_{0};
+
+    friend class jagged_vector;
+    friend class row_iterator<true>;
+
+    row_iterator(container* c, const size_type index) noexcept : c_{c}, index_{index} {}
+
+   public:
+    row_iterator() = default;
+
+    row_iterator(const row_iterator<!Const>& other) noexcept
+      requires Const
+        : c_{other.c_}, index_{other.index_} {}
+
+    [[nodiscard]] reference operator*() const noexcept { return (*c_)[index_]; }
+
+    [[nodiscard]] reference operator[](const difference_type n) const noexcept { return (*c_)[index_ + n]; }
+
+    row_iterator& operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+
+    row_iterator operator++(int) noexcept {
+      row_iterator res(*this);
+      ++index_;
+      return res;
+    }
+
+    row_iterator& operator--() noexcept {
+      --index_;
+      return *this;
+    }
+
+    row_iterator operator--(int) noexcept {
+      row_iterator res(*this);
+      --index_;
+      return res;
+    }
+
+    row_iterator& operator+=(const difference_type n) noexcept {
+      index_ += n;
+      return *this;
+    }
+
+    row_iterator& operator-=(const difference_type n) noexcept {
+      index_ -= n;
+      return *this;
+    }
+
+    [[nodiscard]] friend row_iterator operator+(row_iterator it, const difference_type n) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend row_iterator operator+(const difference_type n, row_iterator it) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend row_iterator operator-(row_iterator it, const difference_type n) noexcept {
+      return it -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator-(const row_iterator& lhs, const row_iterator& rhs) noexcept {
+      return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    [[nodiscard]] friend bool operator==(const row_iterator& lhs, const row_iterator& rhs) noexcept {
+      return lhs.index_ == rhs.index_;
+    }
+
+    [[nodiscard]] friend std::strong_ordering operator<=>(const row_iterator& lhs, const row_iterator& rhs) noexcept {
+      return lhs.index_ <=> rhs.index_;
+    }
+
+  };  // class row_iterator
+
+};  // class jagged_vector
+
+template <class T, class Offset, class Allocator>
+struct is_trivially_relocatable<jagged_vector<T, Offset, Allocator>>
+    : std::conjunction<is_trivially_relocatable<typename jagged_vector<T, Offset, Allocator>::values_type>,
+                       is_trivially_relocatable<typename jagged_vector<T, Offset, Allocator>::offsets_type>> {};
+
+template <class T, class Offset, class Alloc>
+bool operator==(const jagged_vector<T, Offset, Alloc>& lhs, const jagged_vector<T, Offset, Alloc>& rhs) {
+  return lhs.rows() == rhs.rows() && std::ranges::equal(lhs.offsets(), rhs.offsets()) &&
+         std::ranges::equal(lhs.values(), rhs.values());
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class T, class Offset, class Alloc>
+void swap(ciel::jagged_vector<T, Offset, Alloc>& lhs, ciel::jagged_vector<T, Offset, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
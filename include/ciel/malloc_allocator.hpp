@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== malloc_allocator ====================
+
+// Allocates with std::malloc and deallocates with std::free, so that buffers can cross C APIs in both directions,
+// e.g. a decoder's malloc'd output adopted by a vector, or a vector's buffer released to a C library that frees it.
+template <class T>
+class malloc_allocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t), "std::malloc doesn't support over-aligned types.");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using is_always_equal = std::true_type;
+
+  malloc_allocator() noexcept = default;
+
+  template <class U>
+  malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+  [[nodiscard]] T* allocate(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    void* res = std::malloc(n * sizeof(T));
+    if (res == nullptr) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    return static_cast<T*>(res);
+  }
+
+  // With std::calloc, large blocks come straight from fresh, zero pages.
+  [[nodiscard]] T* allocate_zeroed(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    void* res = std::calloc(n, sizeof(T));
+    if (res == nullptr) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    return static_cast<T*>(res);
+  }
+
+  void deallocate(T* p, size_type) noexcept { std::free(p); }
+
+  [[nodiscard]] size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+  template <class U>
+  friend bool operator==(const malloc_allocator&, const malloc_allocator<U>&) noexcept {
+    return true;
+  }
+
+};  // class malloc_allocator
+
+}  // namespace v
+}  // namespace ciel
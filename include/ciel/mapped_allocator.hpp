@@ -0,0 +1,334 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== mapped_file ====================
+
+// A file that holds one vector buffer, mapped into memory. The file starts with a one page header, the elements
+// follow it, so loading the vector back is only a mapping and pages are read lazily on first access.
+//
+// The whole max_bytes of address space is reserved up front, so growth is an ftruncate and a mapping of the new
+// tail right after the old one: the buffer never moves and nothing is copied.
+//
+// Not thread safe. The file can't be shared by two live buffers, so an allocation while one is alive throws.
+class mapped_file {
+ public:
+  static constexpr size_t default_max_bytes = sizeof(void*) == 8 ? size_t{1} << 40 : size_t{1} << 30;
+
+ private:
+  struct header {
+    uint64_t magic;
+    uint64_t value_size;
+    uint64_t size;
+    uint64_t capacity_bytes;
+  };
+
+  static constexpr uint64_t magic = 0x31454C4946434D43;  // "CMCFILE1"
+
+  int fd_{-1};
+  std::byte* base_{nullptr};
+  size_t page_size_{0};
+  size_t reserved_bytes_{0};  // header page included
+  size_t mapped_bytes_{0};    // header page included
+  bool in_use_{false};
+
+  friend struct mapped_file_access;
+
+  [[noreturn]] static void throw_errno(const char* what) {
+    CIEL_THROW_EXCEPTION(std::system_error(errno, std::generic_category(), what));
+  }
+
+  [[nodiscard]] size_t round_up_page(const size_t bytes) const noexcept {
+    return (bytes + page_size_ - 1) / page_size_ * page_size_;
+  }
+
+  [[nodiscard]] header& head() const noexcept { return *reinterpret_cast<header*>(base_); }
+
+  // Resizes the file to page_size_ + data_bytes, and maps or unmaps its tail.
+  [[nodiscard]] bool resize_file(const size_t data_bytes) noexcept {
+    if (data_bytes > reserved_bytes_ - page_size_) {
+      return false;
+    }
+
+    const size_t file_bytes = page_size_ + data_bytes;
+    const size_t new_mapped = round_up_page(file_bytes);
+
+    if (::ftruncate(fd_, static_cast<off_t>(file_bytes)) != 0) {
+      return false;
+    }
+
+    if (new_mapped > mapped_bytes_) {
+      if (::mmap(base_ + mapped_bytes_, new_mapped - mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                 fd_, static_cast<off_t>(mapped_bytes_)) == MAP_FAILED) {
+        return false;
+      }
+
+    } else if (new_mapped < mapped_bytes_) {
+      // Gives the tail back to the reservation.
+      if (::mmap(base_ + new_mapped, mapped_bytes_ - new_mapped, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                 -1, 0) == MAP_FAILED) {
+        return false;
+      }
+    }
+
+    mapped_bytes_ = new_mapped;
+    head().capacity_bytes = data_bytes;
+    return true;
+  }
+
+  void release() noexcept {
+    if (base_) {
+      ::munmap(base_, reserved_bytes_);
+    }
+
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+ public:
+  // Opens or creates the file at path. An existing file must have been written by mapped_file.
+  explicit mapped_file(const char* path, const size_t max_bytes = default_max_bytes)
+      : page_size_(static_cast<size_t>(::sysconf(_SC_PAGESIZE))) {
+#ifdef __cpp_exceptions
+    try {
+#endif
+      fd_ = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (fd_ == -1) {
+        throw_errno("ciel::mapped_file can't open the file");
+      }
+
+      struct stat st;
+      if (::fstat(fd_, &st) != 0) {
+        throw_errno("ciel::mapped_file can't stat the file");
+      }
+
+      const size_t file_bytes = static_cast<size_t>(st.st_size);
+      reserved_bytes_ = round_up_page(page_size_ + max_bytes);
+
+      if (file_bytes > reserved_bytes_) [[unlikely]] {
+        CIEL_THROW_EXCEPTION(std::length_error("ciel::mapped_file the file is larger than max_bytes"));
+      }
+
+      int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+      flags |= MAP_NORESERVE;
+#endif
+      void* reservation = ::mmap(nullptr, reserved_bytes_, PROT_NONE, flags, -1, 0);
+      if (reservation == MAP_FAILED) {
+        throw_errno("ciel::mapped_file can't reserve address space");
+      }
+
+      base_ = static_cast<std::byte*>(reservation);
+
+      if (file_bytes == 0) {
+        if (!resize_file(0)) {
+          throw_errno("ciel::mapped_file can't map the file");
+        }
+
+        head() = header{magic, 0, 0, 0};
+
+      } else {
+        mapped_bytes_ = round_up_page(file_bytes);
+
+        if (file_bytes < page_size_ ||
+            ::mmap(base_, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd_, 0) == MAP_FAILED) {
+          CIEL_THROW_EXCEPTION(std::runtime_error("ciel::mapped_file can't map the file"));
+        }
+
+        if (head().magic != magic || head().capacity_bytes != file_bytes - page_size_ ||
+            head().size * head().value_size > head().capacity_bytes) [[unlikely]] {
+          CIEL_THROW_EXCEPTION(std::runtime_error("ciel::mapped_file the file is not a mapped vector"));
+        }
+      }
+#ifdef __cpp_exceptions
+    } catch (...) {
+      release();
+      throw;
+    }
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  ~mapped_file() {
+    assert(!in_use_);
+
+    release();
+  }
+
+  [[nodiscard]] size_t max_bytes() const noexcept { return reserved_bytes_ - page_size_; }
+
+  // Size in bytes of the buffer stored in the file.
+  [[nodiscard]] size_t capacity_bytes() const noexcept { return head().capacity_bytes; }
+
+  // Flushes the header and the elements to the file.
+  void sync() {
+    if (::msync(base_, mapped_bytes_, MS_SYNC) != 0) {
+      throw_errno("ciel::mapped_file::sync failed");
+    }
+  }
+
+  [[nodiscard]] void* allocate(const size_t bytes) {
+    if (in_use_) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    if (!resize_file(bytes)) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    head().value_size = 0;
+    head().size = 0;
+    in_use_ = true;
+
+    return base_ + page_size_;
+  }
+
+  [[nodiscard]] bool expand_in_place(void* p, const size_t new_bytes) noexcept {
+    assert(in_use_);
+    assert(p == base_ + page_size_);
+    static_cast<void>(p);
+
+    return resize_file(new_bytes);
+  }
+
+  // The elements are kept in the file, to be loaded back later.
+  void deallocate(void* p) noexcept {
+    assert(in_use_);
+    assert(p == base_ + page_size_);
+    static_cast<void>(p);
+
+    in_use_ = false;
+  }
+
+};  // class mapped_file
+
+// ==================== mapped_allocator ====================
+
+// Allocates vector buffers from a mapped_file, and grows them in place.
+template <class T>
+class mapped_allocator {
+  static_assert(std::is_trivially_copyable_v<T>, "mapped_allocator stores objects as bytes in a file.");
+
+  template <class>
+  friend class mapped_allocator;
+
+  mapped_file* file_;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  explicit mapped_allocator(mapped_file& file) noexcept : file_{std::addressof(file)} {}
+
+  template <class U>
+  mapped_allocator(const mapped_allocator<U>& other) noexcept : file_{other.file_} {}
+
+  [[nodiscard]] mapped_file& file() const noexcept { return *file_; }
+
+  [[nodiscard]] T* allocate(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    return static_cast<T*>(file_->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_type) noexcept { file_->deallocate(p); }
+
+  [[nodiscard]] bool expand_in_place(T* p, size_type, const size_type new_n) noexcept {
+    return new_n <= max_size() && file_->expand_in_place(p, new_n * sizeof(T));
+  }
+
+  [[nodiscard]] size_type max_size() const noexcept { return file_->max_bytes() / sizeof(T); }
+
+  template <class U>
+  friend bool operator==(const mapped_allocator& lhs, const mapped_allocator<U>& rhs) noexcept {
+    return lhs.file_ == rhs.file_;
+  }
+
+};  // class mapped_allocator
+
+template <class T>
+using mapped_vector = vector<T, mapped_allocator<T>>;
+
+struct mapped_file_access {
+  template <class T>
+  static mapped_vector<T> load(mapped_file& file) {
+    const mapped_allocator<T> alloc(file);
+    const auto& head = file.head();
+
+    if (head.size == 0) {
+      return mapped_vector<T>(alloc);
+    }
+
+    if (head.value_size != sizeof(T)) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::load_mapped_vector the file holds another element type"));
+    }
+
+    if (file.in_use_) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::load_mapped_vector the file is already in use"));
+    }
+
+    file.in_use_ = true;
+
+    // Trivially copyable elements are implicitly created by the mapping.
+    T* first = std::launder(reinterpret_cast<T*>(file.base_ + file.page_size_));
+    return mapped_vector<T>::adopt(first, head.size, head.capacity_bytes / sizeof(T), alloc);
+  }
+
+  template <class T>
+  static void sync(const mapped_vector<T>& v) {
+    mapped_file& file = v.get_allocator().file();
+
+    file.head().value_size = sizeof(T);
+    file.head().size = v.size();
+
+    file.sync();
+  }
+
+};  // struct mapped_file_access
+
+// Returns the vector stored in file, without reading or copying its elements. It's empty if there is none.
+template <class T>
+[[nodiscard]] mapped_vector<T> load_mapped_vector(mapped_file& file) {
+  return mapped_file_access::load<T>(file);
+}
+
+// Records v's size in its file and flushes it, so that load_mapped_vector can find v later.
+template <class T>
+void sync_mapped_vector(const mapped_vector<T>& v) {
+  mapped_file_access::sync(v);
+}
+
+}  // namespace v
+}  // namespace ciel
+
+#endif
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <version>
+
+#if __has_include(<mdspan>)
+#include <mdspan>
+#endif
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== pad_rows ====================
+
+struct pad_rows_t {};
+
+inline constexpr pad_rows_t pad_rows;
+
+// ==================== matrix ====================
+
+// A dynamic row-major 2D matrix stored in one vector. Row r spans [r * stride(), r * stride() + cols()).
+// Appending a row is amortized O(1) through vector's growth, and inserting or erasing a column is one
+// pass over the buffer.
+//
+// When constructed with pad_rows, the stride is rounded up to whole cache lines, so with an aligned
+// allocator every row starts on a cache line. Padding elements are valid objects with unspecified values,
+// and inserting a column that fits in the padding doesn't reallocate.
+template <class T, class Allocator = std::allocator<T>>
+class matrix {
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using container_type = vector<value_type, allocator_type>;
+  using size_type = container_type::size_type;
+  using difference_type = container_type::difference_type;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using row_type = std::span<value_type>;
+  using const_row_type = std::span<const value_type>;
+
+#if defined(__cpp_lib_mdspan)
+  using mdspan_type = std::mdspan<value_type, std::dextents<size_type, 2>, std::layout_stride>;
+  using const_mdspan_type = std::mdspan<const value_type, std::dextents<size_type, 2>, std::layout_stride>;
+#endif
+
+ private:
+  container_type data_;  // data_.size() == rows_ * stride_
+  size_type rows_{0};
+  size_type cols_{0};
+  size_type stride_{0};
+  bool padded_{false};
+
+  // Elements per cache line.
+  static constexpr size_type lane =
+      sizeof(value_type) < 64 && 64 % sizeof(value_type) == 0 ? 64 / sizeof(value_type) : 1;
+
+  [[nodiscard]] size_type stride_for(const size_type cols) const noexcept {
+    return padded_ ? (cols + lane - 1) / lane * lane : cols;
+  }
+
+  // Old elements are moved to a new buffer only when nothing after that can throw, otherwise they are copied,
+  // so a throwing value_type leaves the matrix unchanged.
+  static constexpr bool relocate_by_move =
+      (std::is_nothrow_move_constructible_v<value_type> && std::is_nothrow_default_constructible_v<value_type>) ||
+      !std::is_copy_constructible_v<value_type>;
+
+  // Appends [first, last) of another buffer to new_data, which has enough capacity.
+  static void relocate_into(container_type& new_data, value_type* first, value_type* last) {
+    if constexpr (std::is_trivially_copyable_v<value_type>) {
+      new_data.insert(new_data.end(), first, last);
+
+    } else if constexpr (relocate_by_move) {
+      for (; first != last; ++first) {
+        new_data.unchecked_emplace_back(std::move(*first));
+      }
+
+    } else {
+      for (; first != last; ++first) {
+        new_data.unchecked_emplace_back(std::as_const(*first));
+      }
+    }
+  }
+
+  // Inserts column[r] before pos in row r. column is built before this matrix is touched, so it may hold copies
+  // of its elements.
+  void insert_column_impl(const size_type pos, container_type& column) {
+    assert(pos <= cols_);
+    assert(column.size() == rows_);
+
+    const size_type new_cols = cols_ + 1;
+
+    if (rows_ == 0) {
+      cols_ = new_cols;
+      stride_ = std::max(stride_, stride_for(new_cols));
+      return;
+    }
+
+    if (new_cols <= stride_) {
+      // The padding has room, shift the tail of each row in place.
+      for (size_type r = 0; r < rows_; ++r) {
+        value_type* row = data() + r * stride_;
+        std::move_backward(row + pos, row + cols_, row + new_cols);
+        row[pos] = std::move(column[r]);
+      }
+
+      cols_ = new_cols;
+      return;
+    }
+
+    const size_type new_stride = stride_for(new_cols);
+    container_type new_data(reserve_capacity, rows_ * new_stride, data_.get_allocator());
+
+    for (size_type r = 0; r < rows_; ++r) {
+      value_type* row = data() + r * stride_;
+      relocate_into(new_data, row, row + pos);
+      relocate_into(new_data, column.data() + r, column.data() + r + 1);
+      relocate_into(new_data, row + pos, row + cols_);
+
+      for (size_type i = new_cols; i < new_stride; ++i) {
+        new_data.unchecked_emplace_back();
+      }
+    }
+
+    data_.swap(new_data);
+    cols_ = new_cols;
+    stride_ = new_stride;
+  }
+
+ public:
+  matrix() = default;
+
+  explicit matrix(const allocator_type& alloc) : data_(alloc) {}
+
+  matrix(const size_type rows, const size_type cols, const value_type& value = value_type(),
+         const allocator_type& alloc = allocator_type())
+      : data_(rows * cols, value, alloc), rows_{rows}, cols_{cols}, stride_{cols} {}
+
+  matrix(pad_rows_t, const size_type rows, const size_type cols, const value_type& value = value_type(),
+         const allocator_type& alloc = allocator_type())
+      : data_(alloc), rows_{rows}, cols_{cols}, padded_{true} {
+    stride_ = stride_for(cols);
+    data_.assign(rows * stride_, value);
+  }
+
+  matrix(std::initializer_list<std::initializer_list<value_type>> ilist, const allocator_type& alloc = allocator_type())
+      : data_(alloc) {
+    if (ilist.size() != 0) {
+      cols_ = stride_ = ilist.begin()->size();
+      data_.reserve(ilist.size() * stride_);
+    }
+
+    for (const auto& row : ilist) {
+      push_row(row);
+    }
+  }
+
+  matrix(const matrix&) = default;
+
+  matrix(matrix&& other) noexcept
+      : data_(std::move(other.data_)),
+        rows_{std::exchange(other.rows_, 0)},
+        cols_{std::exchange(other.cols_, 0)},
+        stride_{std::exchange(other.stride_, 0)},
+        padded_{other.padded_} {}
+
+  matrix& operator=(const matrix&) = default;
+
+  matrix& operator=(matrix&& other) noexcept {
+    matrix(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return data_.get_allocator(); }
+
+  [[nodiscard]] reference operator()(const size_type r, const size_type c) noexcept {
+    assert(r < rows_);
+    assert(c < cols_);
+
+    return data_[r * stride_ + c];
+  }
+
+  [[nodiscard]] const_reference operator()(const size_type r, const size_type c) const noexcept {
+    assert(r < rows_);
+    assert(c < cols_);
+
+    return data_[r * stride_ + c];
+  }
+
+  [[nodiscard]] reference at(const size_type r, const size_type c) {
+    if (r >= rows_ || c >= cols_) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::matrix::at index is not within the range"));
+    }
+
+    return (*this)(r, c);
+  }
+
+  [[nodiscard]] const_reference at(const size_type r, const size_type c) const {
+    if (r >= rows_ || c >= cols_) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::matrix::at index is not within the range"));
+    }
+
+    return (*this)(r, c);
+  }
+
+  [[nodiscard]] row_type row(const size_type r) noexcept {
+    assert(r < rows_);
+
+    return row_type(data() + r * stride_, cols_);
+  }
+
+  [[nodiscard]] const_row_type row(const size_type r) const noexcept {
+    assert(r < rows_);
+
+    return const_row_type(data() + r * stride_, cols_);
+  }
+
+  [[nodiscard]] row_type operator[](const size_type r) noexcept { return row(r); }
+
+  [[nodiscard]] const_row_type operator[](const size_type r) const noexcept { return row(r); }
+
+  [[nodiscard]] value_type* data() noexcept { return data_.data(); }
+
+  [[nodiscard]] const value_type* data() const noexcept { return data_.data(); }
+
+  // The whole buffer, including padding.
+  [[nodiscard]] const container_type& container() const noexcept { return data_; }
+
+#if defined(__cpp_lib_mdspan)
+  [[nodiscard]] mdspan_type to_mdspan() noexcept {
+    using mapping_type = mdspan_type::mapping_type;
+    using extents_type = mdspan_type::extents_type;
+
+    return mdspan_type(data(), mapping_type(extents_type(rows_, cols_), std::array<size_type, 2>{stride_, 1}));
+  }
+
+  [[nodiscard]] const_mdspan_type to_mdspan() const noexcept {
+    using mapping_type = const_mdspan_type::mapping_type;
+    using extents_type = const_mdspan_type::extents_type;
+
+    return const_mdspan_type(data(), mapping_type(extents_type(rows_, cols_), std::array<size_type, 2>{stride_, 1}));
+  }
+#endif
+
+  [[nodiscard]] bool empty() const noexcept { return rows_ == 0 || cols_ == 0; }
+
+  [[nodiscard]] size_type rows() const noexcept { return rows_; }
+
+  [[nodiscard]] size_type cols() const noexcept { return cols_; }
+
+  // Distance in elements between the starts of two consecutive rows.
+  [[nodiscard]] size_type stride() const noexcept { return stride_; }
+
+  [[nodiscard]] bool padded() const noexcept { return padded_; }
+
+  void reserve_rows(const size_type new_rows) { data_.reserve(new_rows * stride_); }
+
+  void shrink_to_fit() { data_.shrink_to_fit(); }
+
+  // Removes all rows, keeping cols().
+  void clear() noexcept {
+    data_.clear();
+    rows_ = 0;
+  }
+
+  // Appends a row. The first row of a matrix without columns defines cols().
+  template <std::ranges::forward_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, value_type>
+  row_type push_row(R&& r) {
+    const auto n = static_cast<size_type>(std::ranges::distance(r));
+
+    if (rows_ == 0 && cols_ == 0) {
+      cols_ = n;
+      stride_ = stride_for(n);
+
+    } else if (n != cols_) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::invalid_argument("ciel::matrix::push_row size is not equal to cols"));
+    }
+
+    // r may view this matrix, vector::insert constructs the new elements before it releases the old buffer.
+    const size_type old_size = data_.size();
+    data_.insert(data_.end(), std::ranges::begin(r), std::ranges::end(r));
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      data_.resize(old_size + stride_);
+#ifdef __cpp_exceptions
+    } catch (...) {
+      data_.erase(data_.begin() + old_size, data_.end());
+      throw;
+    }
+#endif
+
+    ++rows_;
+    return row(rows_ - 1);
+  }
+
+  row_type push_row(std::initializer_list<value_type> ilist) {
+    return push_row(std::span(ilist.begin(), ilist.size()));
+  }
+
+  // Appends a row of value-initialized elements.
+  row_type emplace_row() {
+    data_.resize(data_.size() + stride_);
+    ++rows_;
+    return row(rows_ - 1);
+  }
+
+  void pop_row() noexcept {
+    assert(rows_ != 0);
+
+    data_.erase(data_.end() - stride_, data_.end());
+    --rows_;
+  }
+
+  void erase_row(const size_type r) {
+    assert(r < rows_);
+
+    const auto first = data_.begin() + r * stride_;
+    data_.erase(first, first + stride_);
+    --rows_;
+  }
+
+  // Inserts a column before pos, filled with value.
+  void insert_column(const size_type pos, const value_type& value) {
+    container_type column(rows_, value, data_.get_allocator());
+    insert_column_impl(pos, column);
+  }
+
+  // Inserts a column before pos, whose element in row r is the r-th element of values. values may view this
+  // matrix.
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, value_type>
+  void insert_column(const size_type pos, R&& values) {
+    container_type column(data_.get_allocator());
+    column.reserve(rows_);
+
+    for (auto&& value : values) {
+      column.emplace_back(std::forward<decltype(value)>(value));
+    }
+
+    insert_column_impl(pos, column);
+  }
+
+  void erase_column(const size_type pos) {
+    assert(pos < cols_);
+
+    const size_type new_cols = cols_ - 1;
+
+    if (padded_) {
+      // Keep the stride, the last slot of each row becomes padding.
+      for (size_type r = 0; r < rows_; ++r) {
+        value_type* row = data() + r * stride_;
+        std::move(row + pos + 1, row + cols_, row + pos);
+      }
+
+      cols_ = new_cols;
+      return;
+    }
+
+    // Compact all rows in one forward pass, then destroy the freed tail of rows() elements.
+    value_type* base = data();
+    value_type* out = base + pos;
+
+    for (size_type r = 0; r < rows_; ++r) {
+      value_type* row = base + r * stride_;
+      if (r != 0) {
+        out = std::move(row, row + pos, out);
+      }
+      out = std::move(row + pos + 1, row + cols_, out);
+    }
+
+    data_.erase(data_.begin() + rows_ * new_cols, data_.end());
+    cols_ = new_cols;
+    stride_ = new_cols;
+  }
+
+  void swap(matrix& other) noexcept {
+    data_.swap(other.data_);
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    std::swap(stride_, other.stride_);
+    std::swap(padded_, other.padded_);
+  }
+
+};  // class matrix
+
+template <class T, class Allocator>
+struct is_trivially_relocatable<matrix<T, Allocator>> : is_trivially_relocatable<vector<T, Allocator>> {};
+
+template <class T, class Alloc>
+bool operator==(const matrix<T, Alloc>& lhs, const matrix<T, Alloc>& rhs) {
+  if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+    return false;
+  }
+
+  for (size_t r = 0; r < lhs.rows(); ++r) {
+    if (!std::ranges::equal(lhs.row(r), rhs.row(r))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class T, class Alloc>
+void swap(ciel::matrix<T, Alloc>& lhs, ciel::matrix<T, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
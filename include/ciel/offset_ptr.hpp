@@ -0,0 +1,158 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace ciel {
+inline namespace v {
+
+// ==================== offset_ptr ====================
+
+// A fancy pointer storing the distance from itself to the pointee, so that a structure of them stays valid
+// wherever the memory holding it is mapped, e.g. a vector in shared memory mapped at different addresses by
+// different processes. Copying recomputes the distance for the new location.
+//
+// It's a contiguous iterator, std::to_address gives the raw pointer, so vector's memcpy paths still apply.
+template <class T>
+class offset_ptr {
+  // Pointing one byte into the offset_ptr itself is meaningless, so that's null.
+  static constexpr uintptr_t null_offset = 1;
+
+  uintptr_t offset_{null_offset};
+
+  template <class>
+  friend class offset_ptr;
+
+  void set(const void* p) noexcept {
+    offset_ = p ? reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(this) : null_offset;
+  }
+
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using difference_type = ptrdiff_t;
+  using pointer = T*;
+  using reference = std::add_lvalue_reference_t<T>;
+  using iterator_category = std::random_access_iterator_tag;
+  using iterator_concept = std::contiguous_iterator_tag;
+
+  template <class U>
+  using rebind = offset_ptr<U>;
+
+  offset_ptr() noexcept = default;
+
+  offset_ptr(std::nullptr_t) noexcept {}
+
+  offset_ptr(T* p) noexcept { set(p); }
+
+  offset_ptr(const offset_ptr& other) noexcept { set(other.get()); }
+
+  template <class U>
+    requires std::is_convertible_v<U*, T*>
+  offset_ptr(const offset_ptr<U>& other) noexcept {
+    set(static_cast<T*>(other.get()));
+  }
+
+  // static_cast from void pointers, as allocator_traits needs.
+  template <class U>
+    requires(std::is_void_v<U> && !std::is_convertible_v<U*, T*>)
+  explicit offset_ptr(const offset_ptr<U>& other) noexcept {
+    set(static_cast<T*>(other.get()));
+  }
+
+  offset_ptr& operator=(const offset_ptr& other) noexcept {
+    set(other.get());
+    return *this;
+  }
+
+  offset_ptr& operator=(std::nullptr_t) noexcept {
+    offset_ = null_offset;
+    return *this;
+  }
+
+  [[nodiscard]] T* get() const noexcept {
+    return offset_ == null_offset ? nullptr : reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + offset_);
+  }
+
+  [[nodiscard]] T* operator->() const noexcept { return get(); }
+
+  template <class U = T>
+    requires(!std::is_void_v<U>)
+  [[nodiscard]] U& operator*() const noexcept {
+    return *get();
+  }
+
+  template <class U = T>
+    requires(!std::is_void_v<U>)
+  [[nodiscard]] U& operator[](const difference_type n) const noexcept {
+    return get()[n];
+  }
+
+  [[nodiscard]] explicit operator bool() const noexcept { return offset_ != null_offset; }
+
+  template <class U = T>
+    requires(!std::is_void_v<U>)
+  [[nodiscard]] static offset_ptr pointer_to(U& r) noexcept {
+    return offset_ptr(std::addressof(r));
+  }
+
+  offset_ptr& operator+=(const difference_type n) noexcept {
+    set(get() + n);
+    return *this;
+  }
+
+  offset_ptr& operator-=(const difference_type n) noexcept {
+    set(get() - n);
+    return *this;
+  }
+
+  offset_ptr& operator++() noexcept { return *this += 1; }
+
+  offset_ptr& operator--() noexcept { return *this -= 1; }
+
+  offset_ptr operator++(int) noexcept {
+    offset_ptr res(*this);
+    ++*this;
+    return res;
+  }
+
+  offset_ptr operator--(int) noexcept {
+    offset_ptr res(*this);
+    --*this;
+    return res;
+  }
+
+  [[nodiscard]] friend offset_ptr operator+(const offset_ptr& p, const difference_type n) noexcept {
+    return offset_ptr(p.get() + n);
+  }
+
+  [[nodiscard]] friend offset_ptr operator+(const difference_type n, const offset_ptr& p) noexcept {
+    return offset_ptr(p.get() + n);
+  }
+
+  [[nodiscard]] friend offset_ptr operator-(const offset_ptr& p, const difference_type n) noexcept {
+    return offset_ptr(p.get() - n);
+  }
+
+  [[nodiscard]] friend difference_type operator-(const offset_ptr& lhs, const offset_ptr& rhs) noexcept {
+    return lhs.get() - rhs.get();
+  }
+
+  [[nodiscard]] friend bool operator==(const offset_ptr& lhs, const offset_ptr& rhs) noexcept {
+    return lhs.get() == rhs.get();
+  }
+
+  [[nodiscard]] friend bool operator==(const offset_ptr& lhs, std::nullptr_t) noexcept { return !lhs; }
+
+  [[nodiscard]] friend std::strong_ordering operator<=>(const offset_ptr& lhs, const offset_ptr& rhs) noexcept {
+    return std::compare_three_way{}(lhs.get(), rhs.get());
+  }
+
+};  // class offset_ptr
+
+}  // namespace v
+}  // namespace ciel
@@ -0,0 +1,628 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+// Inspired by CPython's compact dict.
+
+namespace ciel {
+inline namespace v {
+
+// ==================== ordered_map ====================
+
+// A hash map that iterates in insertion order. Entries live densely in a vector<pair<Key, T>>, and a separate
+// open addressing table of narrow indices (1, 2, 4 or 8 bytes, depending on the table size) points into it.
+// The hash of every entry is kept in a parallel vector, so rehashing only rebuilds the index table.
+//
+// Erased entries are left in place as tombstones, and compacted in batches once they make up half of the
+// entries or when the table grows. Keys must not be modified through iterators.
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<std::pair<Key, T>>>
+class ordered_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+  template <bool Const>
+  class basic_iterator;
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+ private:
+  using alloc_traits = std::allocator_traits<allocator_type>;
+  using entries_type = vector<value_type, allocator_type>;
+  using hashes_type = vector<size_t, typename alloc_traits::template rebind_alloc<size_t>>;
+  using table_type = vector<unsigned char, typename alloc_traits::template rebind_alloc<unsigned char>>;
+
+  static constexpr size_t dead_hash = std::numeric_limits<size_t>::max();
+  static constexpr size_type npos = std::numeric_limits<size_type>::max();
+  static constexpr size_type min_table_size = 8;
+
+  entries_type entries_;
+  hashes_type hashes_;  // hashes_[i] is the hash of entries_[i], or dead_hash for a tombstone.
+  table_type table_;    // table_size_ slots of index_width_ bytes, all ones means empty.
+  size_type table_size_{0};
+  size_type index_width_{1};
+  size_type dead_{0};
+  [[no_unique_address]] hasher hash_;
+  [[no_unique_address]] key_equal equal_;
+
+  [[nodiscard]] static constexpr size_type usable(const size_type table_size) noexcept {
+    return table_size / 3 * 2;
+  }
+
+  // dead_hash is reserved for tombstones.
+  [[nodiscard]] size_t hash_of(const key_type& key) const {
+    const size_t h = hash_(key);
+    return h == dead_hash ? h - 1 : h;
+  }
+
+  // Calls f with std::type_identity<I>, where I is the unsigned integer type of the index table.
+  template <class F>
+  decltype(auto) with_index_type(F&& f) const {
+    switch (index_width_) {
+      case 1:
+        return f(std::type_identity<uint8_t>{});
+      case 2:
+        return f(std::type_identity<uint16_t>{});
+      case 4:
+        return f(std::type_identity<uint32_t>{});
+      default:
+        return f(std::type_identity<uint64_t>{});
+    }
+  }
+
+  template <class I>
+  [[nodiscard]] size_type load(const size_type slot) const noexcept {
+    I res;
+    std::memcpy(&res, table_.data() + slot * sizeof(I), sizeof(I));
+    return res == std::numeric_limits<I>::max() ? npos : static_cast<size_type>(res);
+  }
+
+  template <class I>
+  void store(const size_type slot, const size_type index) noexcept {
+    const I value = static_cast<I>(index);
+    std::memcpy(table_.data() + slot * sizeof(I), &value, sizeof(I));
+  }
+
+  // Returns the index of key in entries_, or npos.
+  [[nodiscard]] size_type find_index(const key_type& key, const size_t h) const {
+    if (table_size_ == 0) {
+      return npos;
+    }
+
+    return with_index_type([&]<class I>(std::type_identity<I>) {
+      const size_type mask = table_size_ - 1;
+
+      for (size_type slot = h & mask;; slot = (slot + 1) & mask) {
+        const size_type index = load<I>(slot);
+
+        if (index == npos) {
+          return npos;
+        }
+
+        if (hashes_[index] == h && equal_(entries_[index].first, key)) {
+          return index;
+        }
+      }
+    });
+  }
+
+  void insert_index(const size_type index) noexcept {
+    with_index_type([&]<class I>(std::type_identity<I>) {
+      const size_type mask = table_size_ - 1;
+
+      for (size_type slot = hashes_[index] & mask;; slot = (slot + 1) & mask) {
+        if (load<I>(slot) == npos) {
+          store<I>(slot, index);
+          return;
+        }
+      }
+    });
+  }
+
+  // Width in bytes of each slot of a table with table_size slots.
+  [[nodiscard]] static constexpr size_type width_for(const size_type table_size) noexcept {
+    const size_type max_index = usable(table_size);
+
+    return max_index < std::numeric_limits<uint8_t>::max()    ? 1
+           : max_index < std::numeric_limits<uint16_t>::max() ? 2
+           : max_index < std::numeric_limits<uint32_t>::max() ? 4
+                                                              : 8;
+  }
+
+  // An empty index table with table_size slots. It is allocated before the map is changed, so a failure leaves
+  // the map as it was.
+  [[nodiscard]] table_type allocate_table(const size_type table_size) const {
+    assert(std::has_single_bit(table_size));
+
+    return table_type(table_size * width_for(table_size), static_cast<unsigned char>(0xFF), table_.get_allocator());
+  }
+
+  // Points every slot of the index table at the live entries. Only hashes_ is read, entries are never touched.
+  void reindex() noexcept {
+    std::fill(table_.begin(), table_.end(), static_cast<unsigned char>(0xFF));
+
+    for (size_type i = 0; i < hashes_.size(); ++i) {
+      if (hashes_[i] != dead_hash) {
+        insert_index(i);
+      }
+    }
+  }
+
+  // Replaces the index table with table, as returned by allocate_table(table_size).
+  void install_table(table_type& table, const size_type table_size) noexcept {
+    assert(usable(table_size) >= entries_.size());
+
+    table_.swap(table);
+    table_size_ = table_size;
+    index_width_ = width_for(table_size);
+    reindex();
+  }
+
+  // Removes all tombstones, preserving the order of live entries. If tracked is given, it is updated to the new
+  // index of that live entry. Nothing is changed if it throws, which can only happen when value_type's move
+  // assignment may throw: the live entries are then moved or copied to a new buffer instead of in place.
+  void compact_entries(size_type* tracked = nullptr) {
+    if (dead_ == 0) {
+      return;
+    }
+
+    if constexpr (std::is_nothrow_move_assignable_v<value_type>) {
+      const value_type* base = entries_.data();
+      const auto new_end = std::remove_if(entries_.begin(), entries_.end(), [&](const value_type& e) {
+        return hashes_[&e - base] == dead_hash;
+      });
+      entries_.erase(new_end, entries_.end());
+
+    } else {
+      entries_type live(reserve_capacity, size(), entries_.get_allocator());
+      for (size_type i = 0; i < entries_.size(); ++i) {
+        if (hashes_[i] != dead_hash) {
+          live.unchecked_emplace_back(ciel::v::move_if_noexcept(entries_[i]));
+        }
+      }
+
+      entries_.swap(live);
+    }
+
+    if (tracked) {
+      *tracked -= std::count(hashes_.begin(), hashes_.begin() + *tracked, dead_hash);
+    }
+
+    hashes_.erase(std::remove(hashes_.begin(), hashes_.end(), dead_hash), hashes_.end());
+    dead_ = 0;
+  }
+
+  // Compacts the entries and rebuilds a table with room for as many again. tracked is as for compact_entries.
+  void grow(size_type* tracked = nullptr) {
+    const size_type need = std::max(size() * 2, size() + 1);
+    size_type new_table_size = min_table_size;
+    while (usable(new_table_size) < need) {
+      new_table_size *= 2;
+    }
+
+    table_type new_table = allocate_table(new_table_size);
+    compact_entries(tracked);
+    install_table(new_table, new_table_size);
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args) {
+    const size_t h = hash_of(key);
+
+    if (const size_type index = find_index(key, h); index != npos) {
+      return {make_iterator(index), false};
+    }
+
+    // The entry is built before any compaction or rehash, so args may refer to existing entries.
+    size_type index = entries_.size();
+    hashes_.push_back(h);
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      entries_.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
+#ifdef __cpp_exceptions
+    } catch (...) {
+      hashes_.pop_back();
+      throw;
+    }
+#endif
+
+    if (entries_.size() <= usable(table_size_)) {
+      insert_index(index);
+      return {make_iterator(index), true};
+    }
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      grow(&index);  // the table is rebuilt with the new entry
+#ifdef __cpp_exceptions
+    } catch (...) {
+      entries_.pop_back();
+      hashes_.pop_back();
+      throw;
+    }
+#endif
+
+    return {make_iterator(index), true};
+  }
+
+  // If tracked is given, it is updated to the new index of that live entry when a compaction happens.
+  void erase_index(const size_type index, size_type* tracked = nullptr) {
+    assert(hashes_[index] != dead_hash);
+
+    // The slot keeps pointing at the tombstone, so probe sequences passing through it stay intact.
+    hashes_[index] = dead_hash;
+    ++dead_;
+
+    if (dead_ * 2 > entries_.size()) {
+      // The table keeps its size, so it is rebuilt in place. Compacting is only an optimization, if it throws
+      // the tombstones stay until the next one.
+#ifdef __cpp_exceptions
+      try {
+#endif
+        compact_entries(tracked);
+        reindex();
+#ifdef __cpp_exceptions
+      } catch (...) {
+      }
+#endif
+    }
+  }
+
+  [[nodiscard]] iterator make_iterator(const size_type index) noexcept {
+    return iterator(entries_.data() + index, hashes_.data() + index, hashes_.data() + hashes_.size());
+  }
+
+  [[nodiscard]] const_iterator make_iterator(const size_type index) const noexcept {
+    return const_iterator(entries_.data() + index, hashes_.data() + index, hashes_.data() + hashes_.size());
+  }
+
+ public:
+  ordered_map() = default;
+
+  ordered_map(const ordered_map&) = default;
+
+  ordered_map(ordered_map&& other) noexcept
+      : entries_(std::move(other.entries_)),
+        hashes_(std::move(other.hashes_)),
+        table_(std::move(other.table_)),
+        table_size_{std::exchange(other.table_size_, 0)},
+        index_width_{std::exchange(other.index_width_, 1)},
+        dead_{std::exchange(other.dead_, 0)},
+        hash_(std::move(other.hash_)),
+        equal_(std::move(other.equal_)) {}
+
+  explicit ordered_map(const size_type bucket_count, const hasher& hash = hasher(),
+                       const key_equal& equal = key_equal(), const allocator_type& alloc = allocator_type())
+      : entries_(alloc), hashes_(alloc), table_(alloc), hash_(hash), equal_(equal) {
+    reserve(bucket_count);
+  }
+
+  template <std::input_iterator Iter>
+  ordered_map(Iter first, Iter last) {
+    insert(first, last);
+  }
+
+  ordered_map(std::initializer_list<value_type> ilist) : ordered_map(ilist.begin(), ilist.end()) {}
+
+  ordered_map& operator=(const ordered_map&) = default;
+
+  ordered_map& operator=(ordered_map&& other) noexcept {
+    ordered_map(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ordered_map& operator=(std::initializer_list<value_type> ilist) {
+    clear();
+    insert(ilist);
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return entries_.get_allocator(); }
+
+  [[nodiscard]] iterator begin() noexcept { return make_iterator(0).skip_dead(); }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return make_iterator(0).skip_dead(); }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] iterator end() noexcept { return make_iterator(entries_.size()); }
+
+  [[nodiscard]] const_iterator end() const noexcept { return make_iterator(entries_.size()); }
+
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  [[nodiscard]] size_type size() const noexcept { return entries_.size() - dead_; }
+
+  [[nodiscard]] size_type max_size() const noexcept { return entries_.max_size(); }
+
+  // Width in bytes of each slot of the index table.
+  [[nodiscard]] size_type index_width() const noexcept { return index_width_; }
+
+  void clear() noexcept {
+    entries_.clear();
+    hashes_.clear();
+    std::fill(table_.begin(), table_.end(), static_cast<unsigned char>(0xFF));
+    dead_ = 0;
+  }
+
+  void reserve(const size_type count) {
+    size_type new_table_size = min_table_size;
+    while (usable(new_table_size) < count) {
+      new_table_size *= 2;
+    }
+
+    if (new_table_size > table_size_) {
+      entries_.reserve(count);
+      hashes_.reserve(count);
+
+      table_type new_table = allocate_table(new_table_size);
+      compact_entries();
+      install_table(new_table, new_table_size);
+    }
+  }
+
+  // Removes tombstones and rebuilds the index table.
+  void compact() {
+    if (dead_ != 0) {
+      compact_entries();
+      reindex();
+    }
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) { return try_emplace_impl(value.first, value.second); }
+
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return try_emplace_impl(std::move(value.first), std::move(value.second));
+  }
+
+  template <std::input_iterator Iter>
+  void insert(Iter first, Iter last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+    auto res = try_emplace_impl(key, std::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = std::forward<M>(obj);
+    }
+
+    return res;
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj) {
+    auto res = try_emplace_impl(std::move(key), std::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = std::forward<M>(obj);
+    }
+
+    return res;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    return insert(std::move(value));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+    return try_emplace_impl(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+  }
+
+  // Iterators other than the returned one are invalidated if a compaction happens.
+  iterator erase(const_iterator pos) {
+    const size_type index = pos.entry_ - entries_.data();
+    ++pos;
+
+    if (pos == end()) {
+      erase_index(index);
+      return end();
+    }
+
+    size_type next = pos.entry_ - entries_.data();
+    erase_index(index, &next);
+    return make_iterator(next);
+  }
+
+  size_type erase(const key_type& key) {
+    const size_type index = find_index(key, hash_of(key));
+    if (index == npos) {
+      return 0;
+    }
+
+    erase_index(index);
+    return 1;
+  }
+
+  void swap(ordered_map& other) noexcept {
+    using std::swap;
+
+    entries_.swap(other.entries_);
+    hashes_.swap(other.hashes_);
+    table_.swap(other.table_);
+    swap(table_size_, other.table_size_);
+    swap(index_width_, other.index_width_);
+    swap(dead_, other.dead_);
+    swap(hash_, other.hash_);
+    swap(equal_, other.equal_);
+  }
+
+  [[nodiscard]] mapped_type& at(const key_type& key) {
+    const size_type index = find_index(key, hash_of(key));
+    if (index == npos) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::ordered_map::at key is not found"));
+    }
+
+    return entries_[index].second;
+  }
+
+  [[nodiscard]] const mapped_type& at(const key_type& key) const {
+    const size_type index = find_index(key, hash_of(key));
+    if (index == npos) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::ordered_map::at key is not found"));
+    }
+
+    return entries_[index].second;
+  }
+
+  mapped_type& operator[](const key_type& key) { return try_emplace_impl(key).first->second; }
+
+  mapped_type& operator[](key_type&& key) { return try_emplace_impl(std::move(key)).first->second; }
+
+  [[nodiscard]] size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+  [[nodiscard]] iterator find(const key_type& key) {
+    const size_type index = find_index(key, hash_of(key));
+    return index == npos ? end() : make_iterator(index);
+  }
+
+  [[nodiscard]] const_iterator find(const key_type& key) const {
+    const size_type index = find_index(key, hash_of(key));
+    return index == npos ? end() : make_iterator(index);
+  }
+
+  [[nodiscard]] bool contains(const key_type& key) const { return find_index(key, hash_of(key)) != npos; }
+
+  [[nodiscard]] hasher hash_function() const { return hash_; }
+
+  [[nodiscard]] key_equal key_eq() const { return equal_; }
+
+  // ==================== basic_iterator ====================
+
+  template <bool Const>
+  class basic_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ordered_map::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+   private:
+    pointer entry_{nullptr};
+    const size_t* hash_{nullptr};
+    const size_t* hash_end_{nullptr};
+
+    friend class ordered_map;
+    friend class basic_iterator<true>;
+
+    basic_iterator(pointer entry, const size_t* hash, const size_t* hash_end) noexcept
+        : entry_{entry}, hash_{hash}, hash_end_{hash_end} {}
+
+    basic_iterator& skip_dead() noexcept {
+      while (hash_ != hash_end_ && *hash_ == dead_hash) {
+        ++entry_;
+        ++hash_;
+      }
+
+      return *this;
+    }
+
+   public:
+    basic_iterator() = default;
+
+    basic_iterator(const basic_iterator<!Const>& other) noexcept
+      requires Const
+        : entry_{other.entry_}, hash_{other.hash_}, hash_end_{other.hash_end_} {}
+
+    [[nodiscard]] reference operator*() const noexcept { return *entry_; }
+
+    [[nodiscard]] pointer operator->() const noexcept { return entry_; }
+
+    basic_iterator& operator++() noexcept {
+      ++entry_;
+      ++hash_;
+      return skip_dead();
+    }
+
+    basic_iterator operator++(int) noexcept {
+      basic_iterator res(*this);
+      ++*this;
+      return res;
+    }
+
+    [[nodiscard]] friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return lhs.entry_ == rhs.entry_;
+    }
+
+  };  // class basic_iterator
+
+};  // class ordered_map
+
+template <class Key, class T, class Hash, class KeyEqual, class Allocator>
+struct is_trivially_relocatable<ordered_map<Key, T, Hash, KeyEqual, Allocator>>
+    : std::conjunction<is_trivially_relocatable<vector<std::pair<Key, T>, Allocator>>, is_trivially_relocatable<Hash>,
+                       is_trivially_relocatable<KeyEqual>> {};
+
+template <class Key, class T, class Hash, class KeyEqual, class Allocator>
+bool operator==(const ordered_map<Key, T, Hash, KeyEqual, Allocator>& lhs,
+                const ordered_map<Key, T, Hash, KeyEqual, Allocator>& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+
+  for (const auto& [key, value] : lhs) {
+    const auto it = rhs.find(key);
+    if (it == rhs.end() || !(it->second == value)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void swap(ciel::ordered_map<Key, T, Hash, KeyEqual, Alloc>& lhs,
+          ciel::ordered_map<Key, T, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
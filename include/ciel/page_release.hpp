@@ -0,0 +1,73 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== page_release ====================
+
+// Gives the physical pages of a vector's unused capacity back to the OS with madvise, keeping the buffer, its
+// address and the capacity. Only whole pages within [data() + size(), data() + capacity()) are released; they read
+// as zero, or as their old contents for lazy release, and are faulted in again when the vector grows into them.
+//
+// Useful for a large scratch vector reused every cycle: shrink_to_fit would reallocate, and clear keeps every page
+// resident.
+
+enum class page_release {
+  immediate,  // MADV_DONTNEED, the resident size drops right away
+  lazy,       // MADV_FREE where available, the pages are only reclaimed under memory pressure
+};
+
+// Releases the pages of v's unused capacity. Returns the number of bytes released, 0 if none or on failure.
+template <class T, class Allocator>
+size_t shrink_pages(vector<T, Allocator>& v, const page_release mode = page_release::immediate) noexcept {
+  if (v.capacity() == 0) {
+    return 0;
+  }
+
+  const uintptr_t page_size = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+  const T* data = std::to_address(v.data());
+
+  const uintptr_t first = (reinterpret_cast<uintptr_t>(data + v.size()) + page_size - 1) / page_size * page_size;
+  const uintptr_t last = reinterpret_cast<uintptr_t>(data + v.capacity()) / page_size * page_size;
+
+  if (first >= last) {
+    return 0;
+  }
+
+  void* const p = reinterpret_cast<void*>(first);
+  const size_t bytes = last - first;
+
+#ifdef MADV_FREE
+  if (mode == page_release::lazy && ::madvise(p, bytes, MADV_FREE) == 0) {
+    return bytes;
+  }
+#else
+  static_cast<void>(mode);
+#endif
+
+  // MADV_FREE fails on shared mappings, those fall back too.
+  return ::madvise(p, bytes, MADV_DONTNEED) == 0 ? bytes : 0;
+}
+
+// clear() followed by shrink_pages(), only the pages in use by the allocator itself, if any, stay resident.
+template <class T, class Allocator>
+size_t clear_and_release(vector<T, Allocator>& v, const page_release mode = page_release::immediate) noexcept {
+  v.clear();
+  return shrink_pages(v, mode);
+}
+
+}  // namespace v
+}  // namespace ciel
+
+#endif
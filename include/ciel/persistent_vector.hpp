@@ -0,0 +1,1094 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+// Inspired by Clojure's PersistentVector, immer's flex_vector and the RRB-tree paper (Bagwell & Rompf).
+
+namespace ciel {
+inline namespace v {
+
+// ==================== persistent_vector ====================
+
+// An immutable sequence with structural sharing. Every node carries a cumulative size table (a fully relaxed
+// radix balanced tree), so that concatenation and slicing only rebuild the O(log n) nodes along the seams.
+// All leaves are kept at the same depth.
+//
+// Modifying operations are const and return a new version, copying only the path from the root to the
+// modified leaf. transient_type mutates uniquely owned nodes in place, which makes bulk loading O(1) amortized
+// per element.
+template <class T, size_t Branch = 32>
+class persistent_vector {
+  static_assert(Branch >= 4, "persistent_vector needs at least 4 slots per node.");
+  static_assert(std::is_same_v<std::remove_cv_t<T>, T>);
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = const value_type&;
+  using const_reference = const value_type&;
+
+  class const_iterator;
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  class transient_type;
+
+ private:
+  // Relocation consumes the source elements, it's only used when the source can't throw halfway.
+  static constexpr bool can_relocate = is_trivially_relocatable_v<value_type> ||
+                                       std::is_nothrow_move_constructible_v<value_type>;
+
+  struct node {
+    std::atomic<size_t> refcount{1};
+    size_t count{0};
+  };
+
+  struct leaf_node : node {
+    alignas(value_type) unsigned char storage[sizeof(value_type) * Branch];
+
+    [[nodiscard]] value_type* data() noexcept { return reinterpret_cast<value_type*>(storage); }
+  };
+
+  struct inner_node : node {
+    node* children[Branch];
+    size_t sizes[Branch];  // sizes[i] is the number of elements in children[0, i].
+  };
+
+  // Releases the node in destructor for exception handling. Null pointers are ignored.
+  struct node_guard {
+    node* ptr;
+    size_t height;
+
+    node_guard(node* p, const size_t h) noexcept : ptr{p}, height{h} {}
+
+    node_guard(const node_guard&) = delete;
+    node_guard& operator=(const node_guard&) = delete;
+
+    ~node_guard() { persistent_vector::release(ptr, height); }
+
+    [[nodiscard]] node* release() noexcept { return std::exchange(ptr, nullptr); }
+  };
+
+  node* root_{nullptr};
+  size_type height_{0};  // 0 means the root is a leaf.
+  size_type size_{0};
+
+  static void retain(node* n) noexcept { n->refcount.fetch_add(1, std::memory_order_relaxed); }
+
+  [[nodiscard]] static bool unique(const node* n) noexcept {
+    return n->refcount.load(std::memory_order_acquire) == 1;
+  }
+
+  static void release(node* n, const size_type height) noexcept {
+    if (n == nullptr || n->refcount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+
+    if (height == 0) {
+      leaf_node* l = static_cast<leaf_node*>(n);
+      std::destroy_n(l->data(), l->count);
+      delete l;
+
+    } else {
+      inner_node* in = static_cast<inner_node*>(n);
+      for (size_type i = 0; i < in->count; ++i) {
+        release(in->children[i], height - 1);
+      }
+      delete in;
+    }
+  }
+
+  [[nodiscard]] static size_type node_size(const node* n, const size_type height) noexcept {
+    if (height == 0) {
+      return n->count;
+    }
+
+    const inner_node* in = static_cast<const inner_node*>(n);
+    assert(in->count != 0);
+
+    return in->sizes[in->count - 1];
+  }
+
+  [[nodiscard]] static size_type child_index(const inner_node* in, const size_type index) noexcept {
+    assert(index < in->sizes[in->count - 1]);
+
+    size_type i = 0;
+    while (in->sizes[i] <= index) {
+      ++i;
+    }
+
+    return i;
+  }
+
+  static void recompute_sizes(inner_node* in, const size_type height) noexcept {
+    size_type sum = 0;
+    for (size_type i = 0; i < in->count; ++i) {
+      sum += node_size(in->children[i], height - 1);
+      in->sizes[i] = sum;
+    }
+  }
+
+  // Relocates n elements from src to dst, dst must not be after src when ranges overlap.
+  static void relocate_n(value_type* src, const size_type n, value_type* dst) noexcept {
+    static_assert(can_relocate);
+
+    if constexpr (is_trivially_relocatable_v<value_type>) {
+      if (n != 0) {
+        std::memmove(static_cast<void*>(dst), static_cast<void*>(src), sizeof(value_type) * n);
+      }
+
+    } else {
+      for (size_type i = 0; i < n; ++i) {
+        std::construct_at(dst + i, std::move(src[i]));
+        std::destroy_at(src + i);
+      }
+    }
+  }
+
+  // Copies [first, first + n) to the end of dst. dst->count is kept in sync for exception handling.
+  static void leaf_copy_back(leaf_node* dst, const value_type* first, const size_type n) {
+    assert(dst->count + n <= Branch);
+
+    if constexpr (std::is_trivially_copy_constructible_v<value_type>) {
+      std::allocator<value_type> alloc;
+      value_type* out = dst->data() + dst->count;
+      ciel::v::uninitialized_copy(alloc, first, first + n, out);
+      dst->count += n;
+
+    } else {
+      for (size_type i = 0; i < n; ++i) {
+        std::construct_at(dst->data() + dst->count, first[i]);
+        ++dst->count;
+      }
+    }
+  }
+
+  // Moves all elements of src to the end of dst and releases src. Elements are relocated when src is uniquely
+  // owned, otherwise they are copied. On exception src is left untouched.
+  static void leaf_take_back(leaf_node* dst, leaf_node* src) {
+    assert(dst->count + src->count <= Branch);
+
+    if constexpr (can_relocate) {
+      if (unique(src)) {
+        relocate_n(src->data(), src->count, dst->data() + dst->count);
+        dst->count += std::exchange(src->count, 0);
+        release(src, 0);
+        return;
+      }
+    }
+
+    leaf_copy_back(dst, src->data(), src->count);
+    release(src, 0);
+  }
+
+  // Returns a leaf holding elements [first, last) of l and releases l. On exception l is left untouched.
+  [[nodiscard]] static leaf_node* leaf_slice(leaf_node* l, const size_type first, const size_type last) {
+    assert(first < last);
+    assert(last <= l->count);
+
+    if constexpr (can_relocate) {
+      if (unique(l)) {
+        std::destroy(l->data() + last, l->data() + l->count);
+        if (first != 0) {
+          std::destroy_n(l->data(), first);
+          relocate_n(l->data() + first, last - first, l->data());
+        }
+        l->count = last - first;
+        return l;
+      }
+    }
+
+    node_guard g{new leaf_node, 0};
+    leaf_node* res = static_cast<leaf_node*>(g.ptr);
+    leaf_copy_back(res, l->data() + first, last - first);
+    release(l, 0);
+
+    return static_cast<leaf_node*>(g.release());
+  }
+
+  // Returns l if it's uniquely owned, otherwise a copy of it and l is released.
+  [[nodiscard]] static leaf_node* editable_leaf(leaf_node* l) {
+    if (unique(l)) {
+      return l;
+    }
+
+    node_guard g{new leaf_node, 0};
+    leaf_copy_back(static_cast<leaf_node*>(g.ptr), l->data(), l->count);
+    release(l, 0);
+
+    return static_cast<leaf_node*>(g.release());
+  }
+
+  [[nodiscard]] static inner_node* editable_inner(inner_node* in, const size_type height) {
+    if (unique(in)) {
+      return in;
+    }
+
+    inner_node* res = new inner_node;
+    res->count = in->count;
+
+    for (size_type i = 0; i < in->count; ++i) {
+      res->children[i] = in->children[i];
+      res->sizes[i] = in->sizes[i];
+      retain(res->children[i]);
+    }
+
+    release(in, height);
+
+    return res;
+  }
+
+  [[nodiscard]] static node* make_inner(node* const* children, const size_type count, const size_type height) {
+    assert(count <= Branch);
+
+    inner_node* res = new inner_node;
+    std::copy_n(children, count, res->children);
+    res->count = count;
+    recompute_sizes(res, height);
+
+    return res;
+  }
+
+  [[nodiscard]] static const value_type& get(const node* n, size_type height, size_type index) noexcept {
+    while (height != 0) {
+      const inner_node* in = static_cast<const inner_node*>(n);
+      const size_type i = child_index(in, index);
+
+      if (i != 0) {
+        index -= in->sizes[i - 1];
+      }
+
+      n = in->children[i];
+      --height;
+    }
+
+    return static_cast<leaf_node*>(const_cast<node*>(n))->data()[index];
+  }
+
+  // Returns the leaf containing index, and the index of its first element in leaf_first.
+  [[nodiscard]] static const leaf_node* find_leaf(const node* n, size_type height, size_type index,
+                                                  size_type& leaf_first) noexcept {
+    leaf_first = 0;
+
+    while (height != 0) {
+      const inner_node* in = static_cast<const inner_node*>(n);
+      const size_type i = child_index(in, index);
+
+      if (i != 0) {
+        index -= in->sizes[i - 1];
+        leaf_first += in->sizes[i - 1];
+      }
+
+      n = in->children[i];
+      --height;
+    }
+
+    return static_cast<const leaf_node*>(n);
+  }
+
+  // Appends a new element to the rightmost leaf of the subtree in slot. Returns nullptr on success,
+  // or a new chain of height `height` holding the element when the rightmost path is full.
+  template <class... Args>
+  [[nodiscard]] static node* push_back_impl(node*& slot, const size_type height, Args&&... args) {
+    if (height == 0) {
+      leaf_node* l = static_cast<leaf_node*>(slot);
+
+      if (l->count < Branch) {
+        l = editable_leaf(l);
+        slot = l;
+        std::construct_at(l->data() + l->count, std::forward<Args>(args)...);
+        ++l->count;
+        return nullptr;
+      }
+
+      node_guard g{new leaf_node, 0};
+      leaf_node* res = static_cast<leaf_node*>(g.ptr);
+      std::construct_at(res->data(), std::forward<Args>(args)...);
+      res->count = 1;
+      return g.release();
+    }
+
+    inner_node* in = editable_inner(static_cast<inner_node*>(slot), height);
+    slot = in;
+
+    node_guard overflow{push_back_impl(in->children[in->count - 1], height - 1, std::forward<Args>(args)...),
+                        height - 1};
+
+    if (overflow.ptr == nullptr) {
+      ++in->sizes[in->count - 1];
+      return nullptr;
+    }
+
+    if (in->count < Branch) {
+      in->children[in->count] = overflow.release();
+      in->sizes[in->count] = in->sizes[in->count - 1] + 1;
+      ++in->count;
+      return nullptr;
+    }
+
+    inner_node* res = new inner_node;
+    res->children[0] = overflow.release();
+    res->sizes[0] = 1;
+    res->count = 1;
+
+    return res;
+  }
+
+  template <class U>
+  static void set_impl(node*& slot, const size_type height, size_type index, U&& value) {
+    if (height == 0) {
+      leaf_node* l = editable_leaf(static_cast<leaf_node*>(slot));
+      slot = l;
+      l->data()[index] = std::forward<U>(value);
+      return;
+    }
+
+    inner_node* in = editable_inner(static_cast<inner_node*>(slot), height);
+    slot = in;
+
+    const size_type i = child_index(in, index);
+    if (i != 0) {
+      index -= in->sizes[i - 1];
+    }
+
+    set_impl(in->children[i], height - 1, index, std::forward<U>(value));
+  }
+
+  // Distributes count children into one node, or two nodes of about the same size, reusing a and b.
+  static std::pair<node*, node*> redistribute(inner_node* a, inner_node* b, node* const* children,
+                                              const size_type count, const size_type height) noexcept {
+    assert(count <= Branch * 2);
+
+    if (count <= Branch) {
+      std::copy_n(children, count, a->children);
+      a->count = count;
+      recompute_sizes(a, height);
+
+      b->count = 0;
+      release(b, height);
+
+      return {a, nullptr};
+    }
+
+    const size_type half = (count + 1) / 2;
+
+    std::copy_n(children, half, a->children);
+    a->count = half;
+    recompute_sizes(a, height);
+
+    std::copy_n(children + half, count - half, b->children);
+    b->count = count - half;
+    recompute_sizes(b, height);
+
+    return {a, b};
+  }
+
+  // Concatenates l and r, consuming both references. Returns one or two nodes of height max(lh, rh).
+  [[nodiscard]] static std::pair<node*, node*> join(node* l, const size_type lh, node* r, const size_type rh) {
+    node_guard lg{l, lh};
+    node_guard rg{r, rh};
+
+    if (lh == 0 && rh == 0) {
+      if (l->count + r->count > Branch) {
+        return {lg.release(), rg.release()};
+      }
+
+      leaf_node* a = editable_leaf(static_cast<leaf_node*>(l));
+      lg.ptr = a;
+
+      leaf_take_back(a, static_cast<leaf_node*>(r));
+      rg.ptr = nullptr;
+
+      return {lg.release(), nullptr};
+    }
+
+    node* buffer[Branch * 2];
+    size_type count = 0;
+
+    if (lh == rh) {
+      inner_node* a = editable_inner(static_cast<inner_node*>(l), lh);
+      lg.ptr = a;
+      inner_node* b = editable_inner(static_cast<inner_node*>(r), rh);
+      rg.ptr = b;
+
+      node* lc = std::exchange(a->children[a->count - 1], nullptr);
+      node* rc = std::exchange(b->children[0], nullptr);
+      const auto [x, y] = join(lc, lh - 1, rc, rh - 1);
+
+      // No exceptions from now on.
+      count = std::copy_n(a->children, a->count - 1, buffer) - buffer;
+      buffer[count++] = x;
+      if (y) {
+        buffer[count++] = y;
+      }
+      count = std::copy(b->children + 1, b->children + b->count, buffer + count) - buffer;
+
+      lg.ptr = nullptr;
+      rg.ptr = nullptr;
+
+      return redistribute(a, b, buffer, count, lh);
+    }
+
+    if (lh > rh) {
+      inner_node* a = editable_inner(static_cast<inner_node*>(l), lh);
+      lg.ptr = a;
+
+      node* lc = std::exchange(a->children[a->count - 1], nullptr);
+      const auto [x, y] = join(lc, lh - 1, rg.release(), rh);
+      a->children[a->count - 1] = x;
+
+      node_guard yg{y, lh - 1};
+      if (y == nullptr || a->count < Branch) {
+        if (y) {
+          a->children[a->count++] = yg.release();
+        }
+
+        recompute_sizes(a, lh);
+        return {lg.release(), nullptr};
+      }
+
+      inner_node* b = static_cast<inner_node*>(make_inner(nullptr, 0, lh));
+      count = std::copy_n(a->children, a->count, buffer) - buffer;
+      buffer[count++] = yg.release();
+
+      lg.ptr = nullptr;
+      return redistribute(a, b, buffer, count, lh);
+    }
+
+    inner_node* b = editable_inner(static_cast<inner_node*>(r), rh);
+    rg.ptr = b;
+
+    node* rc = std::exchange(b->children[0], nullptr);
+    const auto [x, y] = join(lg.release(), lh, rc, rh - 1);
+    b->children[0] = x;
+
+    node_guard yg{y, rh - 1};
+    if (y == nullptr || b->count < Branch) {
+      if (y) {
+        std::copy_backward(b->children + 1, b->children + b->count, b->children + b->count + 1);
+        b->children[1] = yg.release();
+        ++b->count;
+      }
+
+      recompute_sizes(b, rh);
+      return {rg.release(), nullptr};
+    }
+
+    inner_node* a = static_cast<inner_node*>(make_inner(nullptr, 0, rh));
+    buffer[count++] = x;
+    buffer[count++] = yg.release();
+    count = std::copy(b->children + 1, b->children + b->count, buffer + count) - buffer;
+
+    rg.ptr = nullptr;
+    return redistribute(a, b, buffer, count, rh);
+  }
+
+  // Keeps the first count elements of n, consuming the reference.
+  [[nodiscard]] static node* take_impl(node* n, const size_type height, const size_type count) {
+    assert(count != 0);
+    assert(count <= node_size(n, height));
+
+    if (count == node_size(n, height)) {
+      return n;
+    }
+
+    node_guard g{n, height};
+
+    if (height == 0) {
+      leaf_node* res = leaf_slice(static_cast<leaf_node*>(n), 0, count);
+      g.ptr = nullptr;
+      return res;
+    }
+
+    inner_node* in = editable_inner(static_cast<inner_node*>(n), height);
+    g.ptr = in;
+
+    const size_type i = child_index(in, count - 1);
+    const size_type before = i == 0 ? 0 : in->sizes[i - 1];
+
+    for (size_type j = i + 1; j < in->count; ++j) {
+      release(std::exchange(in->children[j], nullptr), height - 1);
+    }
+    in->count = i + 1;
+
+    node* c = std::exchange(in->children[i], nullptr);
+    in->children[i] = take_impl(c, height - 1, count - before);
+    in->sizes[i] = count;
+
+    return g.release();
+  }
+
+  // Drops the first count elements of n, consuming the reference.
+  [[nodiscard]] static node* drop_impl(node* n, const size_type height, const size_type count) {
+    assert(count < node_size(n, height));
+
+    if (count == 0) {
+      return n;
+    }
+
+    node_guard g{n, height};
+
+    if (height == 0) {
+      leaf_node* res = leaf_slice(static_cast<leaf_node*>(n), count, n->count);
+      g.ptr = nullptr;
+      return res;
+    }
+
+    inner_node* in = editable_inner(static_cast<inner_node*>(n), height);
+    g.ptr = in;
+
+    const size_type i = child_index(in, count);
+    const size_type before = i == 0 ? 0 : in->sizes[i - 1];
+
+    for (size_type j = 0; j < i; ++j) {
+      release(std::exchange(in->children[j], nullptr), height - 1);
+    }
+
+    node* c = std::exchange(in->children[i], nullptr);
+    if (i != 0) {
+      std::copy(in->children + i + 1, in->children + in->count, in->children + 1);
+      in->children[0] = nullptr;
+      in->count -= i;
+    }
+
+    in->children[0] = drop_impl(c, height - 1, count - before);
+    recompute_sizes(in, height);
+
+    return g.release();
+  }
+
+  // Collapses single child roots left by slicing and concatenation.
+  static void normalize(node*& root, size_type& height) noexcept {
+    while (height != 0 && root->count == 1) {
+      node* child = static_cast<inner_node*>(root)->children[0];
+      retain(child);
+      release(root, height);
+      root = child;
+      --height;
+    }
+  }
+
+  template <class... Args>
+  static void emplace_back_impl(node*& root, size_type& height, size_type& size, Args&&... args) {
+    if (root == nullptr) {
+      node_guard g{new leaf_node, 0};
+      std::construct_at(static_cast<leaf_node*>(g.ptr)->data(), std::forward<Args>(args)...);
+      g.ptr->count = 1;
+
+      root = g.release();
+      height = 0;
+      size = 1;
+      return;
+    }
+
+    node_guard overflow{push_back_impl(root, height, std::forward<Args>(args)...), height};
+
+    if (overflow.ptr) {
+      node* children[2]{root, overflow.ptr};
+      root = make_inner(children, 2, height + 1);
+      overflow.ptr = nullptr;
+      ++height;
+    }
+
+    ++size;
+  }
+
+  // Appends the tree (r, rh, rsize) to (root, height, size), consuming the reference r.
+  static void append_impl(node*& root, size_type& height, size_type& size, node* r, const size_type rh,
+                          const size_type rsize) {
+    if (r == nullptr) {
+      return;
+    }
+
+    if (root == nullptr) {
+      root = r;
+      height = rh;
+      size = rsize;
+      return;
+    }
+
+    const size_type lh = std::exchange(height, 0);
+    const size_type lsize = std::exchange(size, 0);
+    const size_type h = std::max(lh, rh);
+    // The tree is left empty on exception.
+    auto [x, y] = join(std::exchange(root, nullptr), lh, r, rh);
+
+    if (y) {
+      node_guard xg{x, h};
+      node_guard yg{y, h};
+      node* children[2]{x, y};
+      root = make_inner(children, 2, h + 1);
+      xg.ptr = nullptr;
+      yg.ptr = nullptr;
+      height = h + 1;
+
+    } else {
+      root = x;
+      height = h;
+    }
+
+    size = lsize + rsize;
+    normalize(root, height);
+  }
+
+  static void take_in_place(node*& root, size_type& height, size_type& size, const size_type count) {
+    if (count >= size) {
+      return;
+    }
+
+    if (count == 0) {
+      release(std::exchange(root, nullptr), height);
+      height = 0;
+      size = 0;
+      return;
+    }
+
+    // The tree is left empty on exception.
+    const size_type h = std::exchange(height, 0);
+    size = 0;
+    root = take_impl(std::exchange(root, nullptr), h, count);
+    height = h;
+    size = count;
+    normalize(root, height);
+  }
+
+  static void drop_in_place(node*& root, size_type& height, size_type& size, const size_type count) {
+    if (count == 0) {
+      return;
+    }
+
+    if (count >= size) {
+      release(std::exchange(root, nullptr), height);
+      height = 0;
+      size = 0;
+      return;
+    }
+
+    // The tree is left empty on exception.
+    const size_type h = std::exchange(height, 0);
+    const size_type s = std::exchange(size, 0);
+    root = drop_impl(std::exchange(root, nullptr), h, count);
+    height = h;
+    size = s - count;
+    normalize(root, height);
+  }
+
+  persistent_vector(node* root, const size_type height, const size_type size) noexcept
+      : root_{root}, height_{height}, size_{size} {}
+
+ public:
+  persistent_vector() = default;
+
+  template <std::input_iterator Iter>
+  persistent_vector(Iter first, Iter last) {
+    transient_type t;
+    for (; first != last; ++first) {
+      t.emplace_back(*first);
+    }
+
+    *this = std::move(t).persistent();
+  }
+
+  persistent_vector(const size_type count, const value_type& value) {
+    transient_type t;
+    for (size_type i = 0; i < count; ++i) {
+      t.emplace_back(value);
+    }
+
+    *this = std::move(t).persistent();
+  }
+
+  persistent_vector(std::initializer_list<value_type> init) : persistent_vector(init.begin(), init.end()) {}
+
+  persistent_vector(const persistent_vector& other) noexcept
+      : root_{other.root_}, height_{other.height_}, size_{other.size_} {
+    if (root_) {
+      retain(root_);
+    }
+  }
+
+  persistent_vector(persistent_vector&& other) noexcept
+      : root_{std::exchange(other.root_, nullptr)},
+        height_{std::exchange(other.height_, 0)},
+        size_{std::exchange(other.size_, 0)} {}
+
+  ~persistent_vector() { release(root_, height_); }
+
+  persistent_vector& operator=(const persistent_vector& other) noexcept {
+    persistent_vector(other).swap(*this);
+    return *this;
+  }
+
+  persistent_vector& operator=(persistent_vector&& other) noexcept {
+    persistent_vector(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  [[nodiscard]] const_reference at(const size_type pos) const {
+    if (pos >= size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::persistent_vector::at pos is not within the range"));
+    }
+
+    return get(root_, height_, pos);
+  }
+
+  [[nodiscard]] const_reference operator[](const size_type pos) const noexcept {
+    assert(pos < size());
+
+    return get(root_, height_, pos);
+  }
+
+  [[nodiscard]] const_reference front() const noexcept {
+    assert(!empty());
+
+    return get(root_, height_, 0);
+  }
+
+  [[nodiscard]] const_reference back() const noexcept {
+    assert(!empty());
+
+    return get(root_, height_, size_ - 1);
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return const_iterator{root_, height_, size_, 0}; }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] const_iterator end() const noexcept { return const_iterator{root_, height_, size_, size_}; }
+
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+  [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+
+  [[nodiscard]] const_reverse_iterator crend() const noexcept { return rend(); }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  [[nodiscard]] size_type size() const noexcept { return size_; }
+
+  [[nodiscard]] size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max(); }
+
+  template <class... Args>
+  [[nodiscard]] persistent_vector emplace_back(Args&&... args) const {
+    persistent_vector res(*this);
+    emplace_back_impl(res.root_, res.height_, res.size_, std::forward<Args>(args)...);
+
+    return res;
+  }
+
+  [[nodiscard]] persistent_vector push_back(const value_type& value) const { return emplace_back(value); }
+
+  [[nodiscard]] persistent_vector push_back(value_type&& value) const { return emplace_back(std::move(value)); }
+
+  template <class U>
+  [[nodiscard]] persistent_vector set(const size_type pos, U&& value) const {
+    assert(pos < size());
+
+    persistent_vector res(*this);
+    set_impl(res.root_, res.height_, pos, std::forward<U>(value));
+
+    return res;
+  }
+
+  [[nodiscard]] persistent_vector concat(const persistent_vector& other) const {
+    persistent_vector res(*this);
+    persistent_vector r(other);
+    append_impl(res.root_, res.height_, res.size_, std::exchange(r.root_, nullptr), r.height_, r.size_);
+
+    return res;
+  }
+
+  // Returns the first count elements.
+  [[nodiscard]] persistent_vector take(const size_type count) const {
+    persistent_vector res(*this);
+    take_in_place(res.root_, res.height_, res.size_, count);
+
+    return res;
+  }
+
+  // Returns all but the first count elements.
+  [[nodiscard]] persistent_vector drop(const size_type count) const {
+    persistent_vector res(*this);
+    drop_in_place(res.root_, res.height_, res.size_, count);
+
+    return res;
+  }
+
+  // Returns elements in [first, last).
+  [[nodiscard]] persistent_vector slice(const size_type first, const size_type last) const {
+    assert(first <= last);
+    assert(last <= size());
+
+    persistent_vector res(*this);
+    take_in_place(res.root_, res.height_, res.size_, last);
+    drop_in_place(res.root_, res.height_, res.size_, first);
+
+    return res;
+  }
+
+  [[nodiscard]] transient_type transient() const& { return transient_type{*this}; }
+
+  [[nodiscard]] transient_type transient() && { return transient_type{std::move(*this)}; }
+
+  void swap(persistent_vector& other) noexcept {
+    using std::swap;
+
+    swap(root_, other.root_);
+    swap(height_, other.height_);
+    swap(size_, other.size_);
+  }
+
+  // ==================== const_iterator ====================
+
+  class const_iterator {
+   public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+   private:
+    const node* root_{nullptr};
+    size_type height_{0};
+    size_type size_{0};
+    size_type index_{0};
+    // Cached leaf holding elements [leaf_first_, leaf_last_).
+    mutable const value_type* leaf_data_{nullptr};
+    mutable size_type leaf_first_{0};
+    mutable size_type leaf_last_{0};
+
+    friend class persistent_vector;
+
+    const_iterator(const node* root, const size_type height, const size_type size, const size_type index) noexcept
+        : root_{root}, height_{height}, size_{size}, index_{index} {}
+
+    void seek() const noexcept {
+      assert(index_ < size_);
+
+      const leaf_node* l = find_leaf(root_, height_, index_, leaf_first_);
+      leaf_data_ = const_cast<leaf_node*>(l)->data();
+      leaf_last_ = leaf_first_ + l->count;
+    }
+
+   public:
+    const_iterator() = default;
+
+    [[nodiscard]] reference operator*() const noexcept {
+      if (index_ < leaf_first_ || leaf_last_ <= index_) {
+        seek();
+      }
+
+      return leaf_data_[index_ - leaf_first_];
+    }
+
+    [[nodiscard]] pointer operator->() const noexcept { return std::addressof(**this); }
+
+    [[nodiscard]] reference operator[](const difference_type n) const noexcept { return *(*this + n); }
+
+    const_iterator& operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+
+    const_iterator operator++(int) noexcept {
+      const_iterator res(*this);
+      ++*this;
+      return res;
+    }
+
+    const_iterator& operator--() noexcept {
+      --index_;
+      return *this;
+    }
+
+    const_iterator operator--(int) noexcept {
+      const_iterator res(*this);
+      --*this;
+      return res;
+    }
+
+    const_iterator& operator+=(const difference_type n) noexcept {
+      index_ += n;
+      return *this;
+    }
+
+    const_iterator& operator-=(const difference_type n) noexcept {
+      index_ -= n;
+      return *this;
+    }
+
+    [[nodiscard]] friend const_iterator operator+(const_iterator it, const difference_type n) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend const_iterator operator+(const difference_type n, const_iterator it) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend const_iterator operator-(const_iterator it, const difference_type n) noexcept {
+      return it -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator-(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+      return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    [[nodiscard]] friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+      return lhs.index_ == rhs.index_;
+    }
+
+    [[nodiscard]] friend std::strong_ordering operator<=>(const const_iterator& lhs,
+                                                          const const_iterator& rhs) noexcept {
+      return lhs.index_ <=> rhs.index_;
+    }
+
+  };  // class const_iterator
+
+  // ==================== transient_type ====================
+
+  // A mutable view of a persistent_vector. Nodes shared with other versions are copied on first modification,
+  // nodes only reachable from this transient are modified in place.
+  class transient_type {
+   private:
+    node* root_{nullptr};
+    size_type height_{0};
+    size_type size_{0};
+
+   public:
+    transient_type() = default;
+
+    explicit transient_type(const persistent_vector& v) noexcept
+        : root_{v.root_}, height_{v.height_}, size_{v.size_} {
+      if (root_) {
+        retain(root_);
+      }
+    }
+
+    explicit transient_type(persistent_vector&& v) noexcept
+        : root_{std::exchange(v.root_, nullptr)},
+          height_{std::exchange(v.height_, 0)},
+          size_{std::exchange(v.size_, 0)} {}
+
+    transient_type(const transient_type&) = delete;
+    transient_type& operator=(const transient_type&) = delete;
+
+    transient_type(transient_type&& other) noexcept
+        : root_{std::exchange(other.root_, nullptr)},
+          height_{std::exchange(other.height_, 0)},
+          size_{std::exchange(other.size_, 0)} {}
+
+    transient_type& operator=(transient_type&& other) noexcept {
+      if (this != std::addressof(other)) [[likely]] {
+        release(root_, height_);
+        root_ = std::exchange(other.root_, nullptr);
+        height_ = std::exchange(other.height_, 0);
+        size_ = std::exchange(other.size_, 0);
+      }
+
+      return *this;
+    }
+
+    ~transient_type() { release(root_, height_); }
+
+    [[nodiscard]] const_reference operator[](const size_type pos) const noexcept {
+      assert(pos < size());
+
+      return get(root_, height_, pos);
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+      emplace_back_impl(root_, height_, size_, std::forward<Args>(args)...);
+    }
+
+    void push_back(const value_type& value) { emplace_back(value); }
+
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    template <class U>
+    void set(const size_type pos, U&& value) {
+      assert(pos < size());
+
+      set_impl(root_, height_, pos, std::forward<U>(value));
+    }
+
+    void append(const persistent_vector& other) { append(persistent_vector(other)); }
+
+    // Leaves of other that are not shared with any other version are relocated rather than copied.
+    void append(persistent_vector&& other) {
+      const size_type h = other.height_;
+      const size_type s = other.size_;
+      append_impl(root_, height_, size_, std::exchange(other.root_, nullptr), h, s);
+      other.height_ = 0;
+      other.size_ = 0;
+    }
+
+    void take(const size_type count) { take_in_place(root_, height_, size_, count); }
+
+    void drop(const size_type count) { drop_in_place(root_, height_, size_, count); }
+
+    void pop_back() {
+      assert(!empty());
+
+      take(size_ - 1);
+    }
+
+    [[nodiscard]] persistent_vector persistent() && noexcept {
+      return persistent_vector{std::exchange(root_, nullptr), std::exchange(height_, 0), std::exchange(size_, 0)};
+    }
+
+  };  // class transient_type
+
+};  // class persistent_vector
+
+template <class T, size_t Branch>
+struct is_trivially_relocatable<persistent_vector<T, Branch>> : std::true_type {};
+
+template <class T, size_t Branch>
+bool operator==(const persistent_vector<T, Branch>& lhs, const persistent_vector<T, Branch>& rhs) {
+  return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, size_t Branch>
+ciel::v::synth_three_way_result<T> operator<=>(const persistent_vector<T, Branch>& lhs,
+                                               const persistent_vector<T, Branch>& rhs) {
+  return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                ciel::v::synth_three_way);
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class T, size_t Branch>
+void swap(ciel::persistent_vector<T, Branch>& lhs, ciel::persistent_vector<T, Branch>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
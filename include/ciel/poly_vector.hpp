@@ -0,0 +1,406 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== poly_vector ====================
+
+// A sequence of polymorphic objects derived from Base, of varying dynamic types and sizes, stored back to back
+// in one contiguous byte arena. Each element is indexed by its offset in the arena, so iteration walks memory
+// sequentially instead of chasing one heap pointer per element like vector<unique_ptr<Base>>.
+//
+// On growth, each object is relocated through a per-type thunk (move construct and destroy), or by memcpy when
+// its type is trivially relocatable. When all objects are, the whole arena is copied with one memcpy.
+//
+// Derived types must be nothrow move constructible (or trivially relocatable), and not over-aligned.
+template <class Base, class Allocator = std::allocator<std::byte>>
+class poly_vector {
+  static_assert(std::is_polymorphic_v<Base>);
+
+ public:
+  using value_type = Base;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+  template <bool Const>
+  class basic_iterator;
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+ private:
+  // Per-type operations.
+  struct element_ops {
+    void (*relocate)(void* dst, void* src) noexcept;  // nullptr means memcpy
+    void (*destroy)(void* p) noexcept;                // nullptr means trivially destructible
+  };
+
+  struct entry {
+    size_type offset;       // of the object in the arena
+    ptrdiff_t base_adjust;  // from the object to its Base subobject
+    size_type size;
+    const element_ops* ops;
+  };
+
+  using unit_type = std::max_align_t;
+  using unit_alloc = std::allocator_traits<allocator_type>::template rebind_alloc<unit_type>;
+  using unit_alloc_traits = std::allocator_traits<unit_alloc>;
+  using entries_type = vector<entry, typename std::allocator_traits<allocator_type>::template rebind_alloc<entry>>;
+
+  template <class D>
+  static constexpr element_ops ops_for{
+      is_trivially_relocatable_v<D> ? nullptr : +[](void* dst, void* src) noexcept {
+        D* s = static_cast<D*>(src);
+        ::new (dst) D(std::move(*s));
+        s->~D();
+      },
+      std::is_trivially_destructible_v<D> ? nullptr : +[](void* p) noexcept { static_cast<D*>(p)->~D(); }};
+
+  unit_type* arena_{nullptr};
+  size_type bytes_{0};
+  size_type capacity_bytes_{0};
+  size_type non_trivial_count_{0};  // of objects that need a relocate thunk
+  entries_type entries_;
+  [[no_unique_address]] unit_alloc alloc_;
+
+  [[nodiscard]] std::byte* arena_bytes() const noexcept { return reinterpret_cast<std::byte*>(arena_); }
+
+  [[nodiscard]] static size_type units_for(const size_type bytes) noexcept {
+    return (bytes + sizeof(unit_type) - 1) / sizeof(unit_type);
+  }
+
+  [[nodiscard]] Base* base_at(const entry& e) const noexcept {
+    return std::launder(reinterpret_cast<Base*>(arena_bytes() + e.offset + e.base_adjust));
+  }
+
+  void destroy_all() noexcept {
+    for (const entry& e : entries_) {
+      if (e.ops->destroy) {
+        e.ops->destroy(arena_bytes() + e.offset);
+      }
+    }
+  }
+
+  void deallocate() noexcept {
+    if (arena_) {
+      unit_alloc_traits::deallocate(alloc_, arena_, units_for(capacity_bytes_));
+      arena_ = nullptr;
+      capacity_bytes_ = 0;
+    }
+  }
+
+  // Relocates every object into new_arena, which replaces the arena.
+  void relocate_to(unit_type* new_arena, const size_type new_capacity_bytes) noexcept {
+    auto* dst = reinterpret_cast<std::byte*>(new_arena);
+
+    if (bytes_ != 0) {
+      if (non_trivial_count_ == 0) {
+        std::memcpy(dst, arena_bytes(), bytes_);
+
+      } else {
+        for (const entry& e : entries_) {
+          if (e.ops->relocate) {
+            e.ops->relocate(dst + e.offset, arena_bytes() + e.offset);
+
+          } else {
+            std::memcpy(dst + e.offset, arena_bytes() + e.offset, e.size);
+          }
+        }
+      }
+    }
+
+    deallocate();
+    arena_ = new_arena;
+    capacity_bytes_ = units_for(new_capacity_bytes) * sizeof(unit_type);
+  }
+
+ public:
+  poly_vector() = default;
+
+  explicit poly_vector(const allocator_type& alloc) : entries_(alloc), alloc_(alloc) {}
+
+  poly_vector(const poly_vector&) = delete;
+  poly_vector& operator=(const poly_vector&) = delete;
+
+  poly_vector(poly_vector&& other) noexcept
+      : arena_{std::exchange(other.arena_, nullptr)},
+        bytes_{std::exchange(other.bytes_, 0)},
+        capacity_bytes_{std::exchange(other.capacity_bytes_, 0)},
+        non_trivial_count_{std::exchange(other.non_trivial_count_, 0)},
+        entries_(std::move(other.entries_)),
+        alloc_(std::move(other.alloc_)) {}
+
+  poly_vector& operator=(poly_vector&& other) noexcept {
+    poly_vector(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~poly_vector() {
+    destroy_all();
+    deallocate();
+  }
+
+  allocator_type get_allocator() const noexcept { return entries_.get_allocator(); }
+
+  [[nodiscard]] reference operator[](const size_type pos) noexcept {
+    assert(pos < size());
+
+    return *base_at(entries_[pos]);
+  }
+
+  [[nodiscard]] const_reference operator[](const size_type pos) const noexcept {
+    assert(pos < size());
+
+    return *base_at(entries_[pos]);
+  }
+
+  [[nodiscard]] reference front() noexcept { return (*this)[0]; }
+
+  [[nodiscard]] const_reference front() const noexcept { return (*this)[0]; }
+
+  [[nodiscard]] reference back() noexcept { return (*this)[size() - 1]; }
+
+  [[nodiscard]] const_reference back() const noexcept { return (*this)[size() - 1]; }
+
+  [[nodiscard]] iterator begin() noexcept { return iterator(this, 0); }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(this, 0); }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] iterator end() noexcept { return iterator(this, size()); }
+
+  [[nodiscard]] const_iterator end() const noexcept { return const_iterator(this, size()); }
+
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] bool empty() const noexcept { return entries_.empty(); }
+
+  [[nodiscard]] size_type size() const noexcept { return entries_.size(); }
+
+  // Bytes of the arena in use, including alignment padding between objects.
+  [[nodiscard]] size_type bytes() const noexcept { return bytes_; }
+
+  [[nodiscard]] size_type capacity_bytes() const noexcept { return capacity_bytes_; }
+
+  void reserve(const size_type new_count, const size_type new_bytes) {
+    entries_.reserve(new_count);
+
+    if (new_bytes > capacity_bytes_) {
+      relocate_to(unit_alloc_traits::allocate(alloc_, units_for(new_bytes)), new_bytes);
+    }
+  }
+
+  void clear() noexcept {
+    destroy_all();
+    entries_.clear();
+    bytes_ = 0;
+    non_trivial_count_ = 0;
+  }
+
+  template <class D, class... Args>
+  D& emplace_back(Args&&... args) {
+    static_assert(std::derived_from<D, Base>);
+    static_assert(std::is_same_v<D, std::remove_cvref_t<D>>);
+    static_assert(alignof(D) <= alignof(unit_type), "poly_vector doesn't support over-aligned types.");
+    static_assert(is_trivially_relocatable_v<D> || std::is_nothrow_move_constructible_v<D>,
+                  "poly_vector relocates elements, which must not throw.");
+
+    const size_type offset = (bytes_ + alignof(D) - 1) / alignof(D) * alignof(D);
+    const size_type new_bytes = offset + sizeof(D);
+
+    if (entries_.size() == entries_.capacity()) {
+      entries_.reserve(std::max<size_type>(entries_.capacity() * 2, 1));
+    }
+
+    // On growth, D is constructed in the new arena before the old one is relocated and freed, so args may refer
+    // to elements of this poly_vector.
+    const size_type new_capacity_bytes = new_bytes > capacity_bytes_ ? std::max(capacity_bytes_ * 2, new_bytes) : 0;
+    unit_type* new_arena =
+        new_capacity_bytes != 0 ? unit_alloc_traits::allocate(alloc_, units_for(new_capacity_bytes)) : nullptr;
+    std::byte* dst = new_arena ? reinterpret_cast<std::byte*>(new_arena) : arena_bytes();
+
+    D* d;
+#ifdef __cpp_exceptions
+    try {
+#endif
+      d = ::new (static_cast<void*>(dst + offset)) D(std::forward<Args>(args)...);
+#ifdef __cpp_exceptions
+    } catch (...) {
+      if (new_arena) {
+        unit_alloc_traits::deallocate(alloc_, new_arena, units_for(new_capacity_bytes));
+      }
+      throw;
+    }
+#endif
+
+    if (new_arena) {
+      relocate_to(new_arena, new_capacity_bytes);
+    }
+
+    const ptrdiff_t base_adjust =
+        reinterpret_cast<std::byte*>(static_cast<Base*>(d)) - reinterpret_cast<std::byte*>(d);
+    entries_.unchecked_emplace_back(offset, base_adjust, sizeof(D), &ops_for<D>);
+
+    bytes_ = new_bytes;
+    if constexpr (!is_trivially_relocatable_v<D>) {
+      ++non_trivial_count_;
+    }
+
+    return *d;
+  }
+
+  void pop_back() noexcept {
+    assert(!empty());
+
+    const entry& e = entries_.back();
+    if (e.ops->destroy) {
+      e.ops->destroy(arena_bytes() + e.offset);
+    }
+    if (e.ops->relocate) {
+      --non_trivial_count_;
+    }
+
+    bytes_ = e.offset;
+    entries_.pop_back();
+  }
+
+  void swap(poly_vector& other) noexcept {
+    using std::swap;
+
+    swap(arena_, other.arena_);
+    swap(bytes_, other.bytes_);
+    swap(capacity_bytes_, other.capacity_bytes_);
+    swap(non_trivial_count_, other.non_trivial_count_);
+    entries_.swap(other.entries_);
+    swap(alloc_, other.alloc_);
+  }
+
+  // ==================== basic_iterator ====================
+
+  template <bool Const>
+  class basic_iterator {
+   public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Base;
+    using difference_type = ptrdiff_t;
+    using pointer = std::conditional_t<Const, const Base*, Base*>;
+    using reference = std::conditional_t<Const, const Base&, Base&>;
+
+   private:
+    using container_pointer = std::conditional_t<Const, const poly_vector*, poly_vector*>;
+
+    container_pointer c_{nullptr};
+    size_type index_{0};
+
+    friend class poly_vector;
+
+    basic_iterator(container_pointer c, const size_type index) noexcept : c_{c}, index_{index} {}
+
+   public:
+    basic_iterator() = default;
+
+    basic_iterator(const basic_iterator<!Const>& other) noexcept
+      requires Const
+        : c_{other.c_}, index_{other.index_} {}
+
+    [[nodiscard]] reference operator*() const noexcept { return (*c_)[index_]; }
+
+    [[nodiscard]] pointer operator->() const noexcept { return std::addressof((*c_)[index_]); }
+
+    [[nodiscard]] reference operator[](const difference_type n) const noexcept { return (*c_)[index_ + n]; }
+
+    basic_iterator& operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+
+    basic_iterator operator++(int) noexcept {
+      basic_iterator res(*this);
+      ++index_;
+      return res;
+    }
+
+    basic_iterator& operator--() noexcept {
+      --index_;
+      return *this;
+    }
+
+    basic_iterator operator--(int) noexcept {
+      basic_iterator res(*this);
+      --index_;
+      return res;
+    }
+
+    basic_iterator& operator+=(const difference_type n) noexcept {
+      index_ += n;
+      return *this;
+    }
+
+    basic_iterator& operator-=(const difference_type n) noexcept {
+      index_ -= n;
+      return *this;
+    }
+
+    [[nodiscard]] friend basic_iterator operator+(basic_iterator it, const difference_type n) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend basic_iterator operator+(const difference_type n, basic_iterator it) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend basic_iterator operator-(basic_iterator it, const difference_type n) noexcept {
+      return it -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    [[nodiscard]] friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return lhs.index_ == rhs.index_;
+    }
+
+    [[nodiscard]] friend std::strong_ordering operator<=>(const basic_iterator& lhs,
+                                                          const basic_iterator& rhs) noexcept {
+      return lhs.index_ <=> rhs.index_;
+    }
+
+  };  // class basic_iterator
+
+};  // class poly_vector
+
+template <class Base, class Allocator>
+struct is_trivially_relocatable<poly_vector<Base, Allocator>>
+    : is_trivially_relocatable<vector<std::byte, Allocator>> {};
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class Base, class Alloc>
+void swap(ciel::poly_vector<Base, Alloc>& lhs, ciel::poly_vector<Base, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
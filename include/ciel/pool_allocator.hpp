@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== pool_cache ====================
+
+// A per thread cache of freed blocks in power of two size classes, from 16 bytes to 1 MiB. vector's capacity
+// doubles on growth, so a growing vector walks up the classes and a short lived one is served from the cache
+// without touching operator new or its locks. Larger blocks bypass the cache.
+//
+// A block freed by another thread joins that thread's cache. Each class keeps at most 1 MiB or 4 blocks,
+// whichever is more, the rest goes back to operator delete.
+//
+// The cache is destroyed at thread exit. Blocks freed after that, e.g. by a pool_vector with static storage
+// duration or one destroyed by another thread_local's destructor, go straight back to operator delete.
+class pool_cache {
+ public:
+  static constexpr size_t min_class_bytes = 16;
+  static constexpr size_t max_class_bytes = size_t{1} << 20;
+
+ private:
+  static constexpr size_t min_shift = std::countr_zero(min_class_bytes);
+  static constexpr size_t class_count = std::countr_zero(max_class_bytes) - min_shift + 1;
+  static constexpr size_t max_cached_bytes = size_t{1} << 20;
+
+  struct node {
+    node* next;
+  };
+
+  static_assert(sizeof(node) <= min_class_bytes);
+
+  // Trivially destructible, so they stay usable while thread_local and static objects are destroyed.
+  static inline thread_local pool_cache* current_ = nullptr;
+  static inline thread_local bool destroyed_ = false;
+
+  node* free_[class_count]{};
+  uint32_t counts_[class_count]{};
+
+  [[nodiscard]] static size_t class_index(const size_t bytes) noexcept {
+    return bytes <= min_class_bytes ? 0 : std::bit_width(bytes - 1) - min_shift;
+  }
+
+  [[nodiscard]] static size_t max_cached(const size_t index) noexcept {
+    return std::max<size_t>(max_cached_bytes >> (index + min_shift), 4);
+  }
+
+  // Size of the block actually allocated for bytes.
+  [[nodiscard]] static size_t block_bytes(const size_t bytes) noexcept {
+    return bytes > max_class_bytes ? bytes : min_class_bytes << class_index(bytes);
+  }
+
+  static void release(void* p, [[maybe_unused]] const size_t block_bytes) noexcept {
+#ifdef __cpp_sized_deallocation
+    ::operator delete(p, block_bytes);
+#else
+    ::operator delete(p);
+#endif
+  }
+
+  // The calling thread's cache, created on first use, or nullptr once it has been destroyed.
+  [[nodiscard]] static pool_cache* try_local() noexcept {
+    if (current_ == nullptr && !destroyed_) [[unlikely]] {
+      static thread_local pool_cache cache;
+    }
+
+    return current_;
+  }
+
+  pool_cache() noexcept { current_ = this; }
+
+ public:
+  pool_cache(const pool_cache&) = delete;
+  pool_cache& operator=(const pool_cache&) = delete;
+
+  ~pool_cache() {
+    trim();
+    current_ = nullptr;
+    destroyed_ = true;
+  }
+
+  // The calling thread's cache. Must not be called once it has been destroyed at thread exit.
+  [[nodiscard]] static pool_cache& local() noexcept {
+    pool_cache* res = try_local();
+    assert(res != nullptr);
+
+    return *res;
+  }
+
+  // allocate and deallocate on the calling thread's cache, or on operator new and delete once it's destroyed.
+  [[nodiscard]] static void* allocate_local(const size_t bytes) {
+    if (pool_cache* cache = try_local()) [[likely]] {
+      return cache->allocate(bytes);
+    }
+
+    return ::operator new(block_bytes(bytes));
+  }
+
+  static void deallocate_local(void* p, const size_t bytes) noexcept {
+    if (pool_cache* cache = try_local()) [[likely]] {
+      cache->deallocate(p, bytes);
+      return;
+    }
+
+    release(p, block_bytes(bytes));
+  }
+
+  [[nodiscard]] void* allocate(const size_t bytes) {
+    if (bytes > max_class_bytes) {
+      return ::operator new(bytes);
+    }
+
+    const size_t index = class_index(bytes);
+
+    if (node* res = free_[index]) {
+      free_[index] = res->next;
+      --counts_[index];
+      return res;
+    }
+
+    return ::operator new(min_class_bytes << index);
+  }
+
+  void deallocate(void* p, const size_t bytes) noexcept {
+    if (bytes > max_class_bytes) {
+      release(p, bytes);
+      return;
+    }
+
+    const size_t index = class_index(bytes);
+
+    if (counts_[index] >= max_cached(index)) {
+      release(p, min_class_bytes << index);
+      return;
+    }
+
+    free_[index] = ::new (p) node{free_[index]};
+    ++counts_[index];
+  }
+
+  // Gives every cached block back to operator delete.
+  void trim() noexcept {
+    for (size_t index = 0; index < class_count; ++index) {
+      while (node* n = free_[index]) {
+        free_[index] = n->next;
+        release(n, min_class_bytes << index);
+      }
+
+      counts_[index] = 0;
+    }
+  }
+
+  // Number of blocks held by the cache.
+  [[nodiscard]] size_t cached_blocks() const noexcept {
+    size_t res = 0;
+    for (const uint32_t count : counts_) {
+      res += count;
+    }
+
+    return res;
+  }
+
+};  // class pool_cache
+
+// ==================== pool_allocator ====================
+
+// Allocates from the calling thread's pool_cache. It doesn't provide construct or destroy, so vector keeps its
+// memcpy paths.
+template <class T>
+class pool_allocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t), "pool_allocator doesn't support over-aligned types.");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using is_always_equal = std::true_type;
+
+  constexpr pool_allocator() noexcept = default;
+
+  template <class U>
+  constexpr pool_allocator(const pool_allocator<U>&) noexcept {}
+
+  [[nodiscard]] T* allocate(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    return static_cast<T*>(pool_cache::allocate_local(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, const size_type n) noexcept { pool_cache::deallocate_local(p, n * sizeof(T)); }
+
+  [[nodiscard]] constexpr size_type max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+  }
+
+  template <class U>
+  [[nodiscard]] friend constexpr bool operator==(const pool_allocator&, const pool_allocator<U>&) noexcept {
+    return true;
+  }
+
+};  // class pool_allocator
+
+template <class T>
+using pool_vector = vector<T, pool_allocator<T>>;
+
+}  // namespace v
+}  // namespace ciel
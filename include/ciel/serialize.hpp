@@ -0,0 +1,296 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vector.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "fd_io.hpp"
+#endif
+
+namespace ciel {
+inline namespace v {
+
+// ==================== serialize ====================
+
+// Binary format for vectors of trivially copyable types, and vectors of such vectors. Each vector is a
+// serialized_header followed by its payload:
+//
+//   flat vector    the count elements as raw bytes, starting payload_offset bytes after the header, so that
+//                  they are aligned relative to the start of the output
+//   nested vector  the count inner vectors, serialized one after another
+//
+// The header records element size, alignment and byte order; reading data written with different ones throws
+// rather than converting it.
+
+struct serialized_header {
+  static constexpr uint32_t magic_value = 0x43455643;  // "CVEC"
+  static constexpr uint16_t version_value = 1;
+
+  uint32_t magic;
+  uint16_t version;
+  uint8_t little_endian;
+  uint8_t nesting;  // 0 for a vector of T, 1 for a vector of vectors of T...
+  uint32_t value_size;
+  uint32_t value_alignment;
+  uint32_t payload_offset;
+  uint32_t reserved;
+  uint64_t count;
+};
+
+static_assert(sizeof(serialized_header) == 32);
+
+struct serialize_impl {
+  template <class T>
+  struct traits {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be serialized.");
+
+    using value_type = T;
+    static constexpr uint8_t nesting = 0;
+  };
+
+  template <class T, class Allocator>
+  struct traits<vector<T, Allocator>> {
+    using value_type = traits<T>::value_type;
+    static constexpr uint8_t nesting = traits<T>::nesting + 1;
+  };
+
+  template <class Vector>
+  static constexpr bool is_flat = traits<Vector>::nesting == 1;
+
+  template <class Vector>
+  [[nodiscard]] static serialized_header make_header(const size_t offset, const size_t count) noexcept {
+    using T = traits<Vector>::value_type;
+
+    const size_t payload_offset =
+        is_flat<Vector> ? (offset + sizeof(serialized_header) + alignof(T) - 1) / alignof(T) * alignof(T) - offset
+                        : sizeof(serialized_header);
+
+    return {serialized_header::magic_value,
+            serialized_header::version_value,
+            std::endian::native == std::endian::little,
+            static_cast<uint8_t>(traits<Vector>::nesting - 1),
+            sizeof(T),
+            alignof(T),
+            static_cast<uint32_t>(payload_offset),
+            0,
+            count};
+  }
+
+  template <class Vector>
+  [[nodiscard]] static size_t size(const Vector& v, const size_t offset) noexcept {
+    if constexpr (is_flat<Vector>) {
+      return make_header<Vector>(offset, v.size()).payload_offset + v.size() * sizeof(typename Vector::value_type);
+
+    } else {
+      size_t res = sizeof(serialized_header);
+
+      for (const auto& inner : v) {
+        res += size(inner, offset + res);
+      }
+
+      return res;
+    }
+  }
+
+  // Writes v at out, which is offset bytes after the start of the output.
+  template <class Vector>
+  static std::byte* write(const Vector& v, std::byte* out, const size_t offset) noexcept {
+    const serialized_header header = make_header<Vector>(offset, v.size());
+    std::memcpy(out, &header, sizeof(header));
+
+    if constexpr (is_flat<Vector>) {
+      std::memset(out + sizeof(header), 0, header.payload_offset - sizeof(header));
+      out += header.payload_offset;
+
+      const size_t bytes = v.size() * sizeof(typename Vector::value_type);
+      if (bytes != 0) {
+        std::memcpy(out, v.data(), bytes);
+      }
+
+      return out + bytes;
+
+    } else {
+      std::byte* const begin = out - offset;
+      out += sizeof(header);
+
+      for (const auto& inner : v) {
+        out = write(inner, out, out - begin);
+      }
+
+      return out;
+    }
+  }
+
+  // Checks and consumes the header at the front of in, returns it.
+  template <class Vector>
+  [[nodiscard]] static serialized_header read_header(std::span<const std::byte>& in) {
+    using T = traits<Vector>::value_type;
+
+    serialized_header header;
+
+    if (in.size() < sizeof(header)) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::deserialize input is truncated"));
+    }
+
+    std::memcpy(&header, in.data(), sizeof(header));
+
+    if (header.magic != serialized_header::magic_value || header.version != serialized_header::version_value)
+        [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::deserialize input is not a serialized vector"));
+    }
+
+    if (header.little_endian != (std::endian::native == std::endian::little) ||
+        header.nesting != traits<Vector>::nesting - 1 || header.value_size != sizeof(T) ||
+        header.value_alignment != alignof(T)) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::deserialize input holds another type"));
+    }
+
+    const size_t payload_offset = is_flat<Vector> ? header.payload_offset : sizeof(header);
+    const size_t max_count = (in.size() - std::min<size_t>(payload_offset, in.size())) / sizeof(T);
+
+    // A nested vector's count is bounded by the number of inner headers.
+    if (payload_offset < sizeof(header) || payload_offset > in.size() ||
+        header.count > (is_flat<Vector> ? max_count : in.size() / sizeof(header))) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::deserialize input is truncated"));
+    }
+
+    in = in.subspan(payload_offset);
+    return header;
+  }
+
+  template <class Vector, class ByteAllocator>
+  static void append(const Vector& v, vector<std::byte, ByteAllocator>& out) {
+    const size_t offset = out.size();
+    const size_t bytes = size(v, offset);
+
+    if constexpr (allocator_has_trivial_construct<ByteAllocator, std::byte*>::value) {
+      // Grows like push_back, so serializing many vectors into one out stays linear.
+      out.reserve_spare(bytes);
+
+      // Bytes are implicitly created by the writes, straight into the spare capacity.
+      std::byte* const dst = std::to_address(out.data()) + offset;
+      [[maybe_unused]] const std::byte* end = write(v, dst, offset);
+      assert(end == dst + bytes);
+      out.unchecked_set_size(offset + bytes);
+
+    } else {
+      out.resize(offset + bytes);
+      write(v, out.data() + offset, offset);
+    }
+  }
+
+  template <class Vector>
+  [[nodiscard]] static Vector read(std::span<const std::byte>& in) {
+    const serialized_header header = read_header<Vector>(in);
+    const size_t count = static_cast<size_t>(header.count);
+
+    Vector res = count == 0 ? Vector() : Vector(reserve_capacity, count);
+
+    if constexpr (is_flat<Vector>) {
+      using T = Vector::value_type;
+      using alloc_type = Vector::allocator_type;
+
+      const size_t bytes = count * sizeof(T);
+
+      if constexpr (allocator_has_trivial_construct<alloc_type, T*, const T&>::value) {
+        // Trivially copyable elements are implicitly created by memcpy, straight into the spare capacity.
+        if (bytes != 0) {
+          std::memcpy(std::to_address(res.data()), in.data(), bytes);
+          res.unchecked_set_size(count);
+        }
+
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          T value;
+          std::memcpy(&value, in.data() + i * sizeof(T), sizeof(T));
+          res.unchecked_emplace_back(value);
+        }
+      }
+
+      in = in.subspan(bytes);
+
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        res.unchecked_emplace_back(read<typename Vector::value_type>(in));
+      }
+    }
+
+    return res;
+  }
+
+};  // struct serialize_impl
+
+// Number of bytes serialize(v, out) appends when out is empty.
+template <class T, class Allocator>
+[[nodiscard]] size_t serialized_size(const vector<T, Allocator>& v) noexcept {
+  return serialize_impl::size(v, 0);
+}
+
+// Appends v to out, writing straight into its spare capacity. A vector of trivially copyable elements is a single
+// memcpy after the header.
+template <class T, class Allocator, class ByteAllocator>
+void serialize(const vector<T, Allocator>& v, vector<std::byte, ByteAllocator>& out) {
+  serialize_impl::append(v, out);
+}
+
+// Reads a Vector from the front of in, and removes what was read from in. The elements are copied straight into
+// the new vector's storage, they are not value-initialized first.
+template <class Vector>
+[[nodiscard]] Vector deserialize(std::span<const std::byte>& in) {
+  return serialize_impl::read<Vector>(in);
+}
+
+// Returns the elements of the vector of T at the front of in without copying them, and removes them from in.
+// The view aliases in, the elements must be suitably aligned in memory, e.g. the output of serialize mapped or
+// read at an aligned address.
+template <class T>
+[[nodiscard]] std::span<const T> deserialize_view(std::span<const std::byte>& in) {
+  const serialized_header header = serialize_impl::read_header<vector<T>>(in);
+  const size_t count = static_cast<size_t>(header.count);
+
+  if (reinterpret_cast<uintptr_t>(in.data()) % alignof(T) != 0) [[unlikely]] {
+    CIEL_THROW_EXCEPTION(std::runtime_error("ciel::deserialize_view input is misaligned"));
+  }
+
+  const T* first = std::launder(reinterpret_cast<const T*>(in.data()));
+  in = in.subspan(count * sizeof(T));
+
+  return std::span<const T>(first, count);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// Writes v to fd as if the output started there. A vector of trivially copyable elements is a single writev
+// of the header and the elements. Returns the number of bytes written, or -1 with errno set.
+template <class T, class Allocator>
+ssize_t serialize_to_fd(const int fd, const vector<T, Allocator>& v) {
+  if constexpr (serialize_impl::is_flat<vector<T, Allocator>>) {
+    const serialized_header header = serialize_impl::make_header<vector<T, Allocator>>(0, v.size());
+    std::byte head[sizeof(header) + alignof(T)]{};
+    std::memcpy(head, &header, sizeof(header));
+
+    iovec iov[2]{{head, header.payload_offset}, {const_cast<T*>(v.data()), v.size() * sizeof(T)}};
+    return writev_all(fd, iov, 2);
+
+  } else {
+    vector<std::byte> out;
+    serialize(v, out);
+    return write_to_fd(fd, out);
+  }
+}
+
+#endif
+
+}  // namespace v
+}  // namespace ciel
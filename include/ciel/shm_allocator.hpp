@@ -0,0 +1,386 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "offset_ptr.hpp"
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== shm_arena ====================
+
+// The allocator state at the start of a shared memory segment. Blocks are found first fit in a free list sorted
+// by address, and merged with their neighbours when freed. Everything is stored as offsets from the arena, and a
+// spin lock on a lock free atomic serializes processes.
+class shm_arena {
+ public:
+  static constexpr size_t alignment = alignof(std::max_align_t);
+
+ private:
+  static constexpr uint64_t magic_value = 0x314D485343455643;  // "CVECSHM1"
+
+  struct block {
+    uint64_t size;  // header included
+    uint64_t next;  // offset of the next free block, 0 for none
+  };
+
+  static constexpr size_t header_size = (sizeof(uint64_t) + alignment - 1) / alignment * alignment;
+  static constexpr size_t min_block = header_size + sizeof(block);
+
+  static_assert(std::atomic<bool>::is_always_lock_free);
+
+  uint64_t magic_;
+  uint64_t size_;
+  uint64_t free_list_;
+  uint64_t root_{0};
+  std::atomic<bool> locked_{false};
+
+  [[nodiscard]] std::byte* base() noexcept { return reinterpret_cast<std::byte*>(this); }
+
+  [[nodiscard]] block* at(const uint64_t offset) noexcept { return reinterpret_cast<block*>(base() + offset); }
+
+  [[nodiscard]] static constexpr size_t first_block() noexcept {
+    return (sizeof(shm_arena) + alignment - 1) / alignment * alignment;
+  }
+
+  struct lock_guard {
+    shm_arena& arena;
+
+    explicit lock_guard(shm_arena& a) noexcept : arena(a) {
+      while (arena.locked_.exchange(true, std::memory_order_acquire)) {
+        while (arena.locked_.load(std::memory_order_relaxed)) {
+        }
+      }
+    }
+
+    ~lock_guard() { arena.locked_.store(false, std::memory_order_release); }
+  };
+
+ public:
+  // Formats size bytes at this into an empty arena.
+  explicit shm_arena(const size_t size) noexcept : magic_{magic_value}, size_{size}, free_list_{first_block()} {
+    assert(size >= first_block() + min_block);
+
+    *at(free_list_) = block{size - first_block(), 0};
+  }
+
+  shm_arena(const shm_arena&) = delete;
+  shm_arena& operator=(const shm_arena&) = delete;
+
+  [[nodiscard]] bool valid(const size_t size) const noexcept { return magic_ == magic_value && size_ == size; }
+
+  [[nodiscard]] void* allocate(const size_t bytes, const size_t align = alignment) {
+    if (align > alignment || bytes > size_) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    const size_t needed = std::max(header_size + (bytes + alignment - 1) / alignment * alignment, min_block);
+
+    lock_guard lg(*this);
+
+    for (uint64_t* link = &free_list_; *link != 0; link = &at(*link)->next) {
+      block* b = at(*link);
+
+      if (b->size < needed) {
+        continue;
+      }
+
+      const uint64_t offset = *link;
+
+      if (b->size - needed >= min_block) {
+        // Split, the rest stays in the list.
+        *at(offset + needed) = block{b->size - needed, b->next};
+        *link = offset + needed;
+        b->size = needed;
+
+      } else {
+        *link = b->next;
+      }
+
+      return base() + offset + header_size;
+    }
+
+    CIEL_THROW_EXCEPTION(std::bad_alloc{});
+  }
+
+  void deallocate(void* p) noexcept {
+    if (p == nullptr) {
+      return;
+    }
+
+    lock_guard lg(*this);
+
+    const uint64_t offset = static_cast<std::byte*>(p) - base() - header_size;
+    block* b = at(offset);
+
+    uint64_t prev = 0;
+    uint64_t* link = &free_list_;
+    while (*link != 0 && *link < offset) {
+      prev = *link;
+      link = &at(*link)->next;
+    }
+
+    b->next = *link;
+    *link = offset;
+
+    if (b->next != 0 && offset + b->size == b->next) {
+      b->size += at(b->next)->size;
+      b->next = at(b->next)->next;
+    }
+
+    if (prev != 0 && prev + at(prev)->size == offset) {
+      at(prev)->size += b->size;
+      at(prev)->next = b->next;
+    }
+  }
+
+  // A well known object for other processes to start from, null if unset.
+  [[nodiscard]] void* root() noexcept { return root_ == 0 ? nullptr : base() + root_; }
+
+  void set_root(void* p) noexcept { root_ = p ? static_cast<std::byte*>(p) - base() : 0; }
+
+  // Bytes in free blocks, headers included.
+  [[nodiscard]] size_t free_bytes() noexcept {
+    lock_guard lg(*this);
+
+    size_t res = 0;
+    for (uint64_t offset = free_list_; offset != 0; offset = at(offset)->next) {
+      res += at(offset)->size;
+    }
+
+    return res;
+  }
+
+};  // class shm_arena
+
+// ==================== shm_segment ====================
+
+// A process local handle to a shared memory segment holding a shm_arena. The segment is an anonymous memfd, or
+// an unlinked POSIX shm object where memfd is not available, so it lives as long as some process maps it or
+// holds its descriptor. Children forked afterwards share the mapping; other processes can map it from fd().
+class shm_segment {
+  int fd_{-1};
+  void* base_{nullptr};
+  size_t size_{0};
+
+  [[noreturn]] static void throw_errno(const char* what) {
+    CIEL_THROW_EXCEPTION(std::system_error(errno, std::generic_category(), what));
+  }
+
+  void map() {
+    base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+    if (base_ == MAP_FAILED) {
+      base_ = nullptr;
+      throw_errno("ciel::shm_segment can't map the segment");
+    }
+  }
+
+  void release() noexcept {
+    if (base_) {
+      ::munmap(base_, size_);
+    }
+
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+ public:
+  // Creates a segment of size bytes with an empty arena.
+  explicit shm_segment(const size_t size) : size_{size} {
+#ifdef __cpp_exceptions
+    try {
+#endif
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+      fd_ = ::memfd_create("ciel_shm", MFD_CLOEXEC);
+#else
+      char name[64];
+      std::snprintf(name, sizeof(name), "/ciel_shm_%ld_%p", static_cast<long>(::getpid()), static_cast<void*>(this));
+      fd_ = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd_ != -1) {
+        ::shm_unlink(name);
+      }
+#endif
+      if (fd_ == -1) {
+        throw_errno("ciel::shm_segment can't create the segment");
+      }
+
+      if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        throw_errno("ciel::shm_segment can't size the segment");
+      }
+
+      map();
+      ::new (base_) shm_arena(size);
+#ifdef __cpp_exceptions
+    } catch (...) {
+      release();
+      throw;
+    }
+#endif
+  }
+
+  // Maps the existing segment behind fd, e.g. received from another process. fd is duplicated.
+  static shm_segment open(const int fd) {
+    shm_segment res;
+
+    res.fd_ = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (res.fd_ == -1) {
+      throw_errno("ciel::shm_segment can't duplicate the descriptor");
+    }
+
+    struct stat st;
+    if (::fstat(res.fd_, &st) != 0) {
+      throw_errno("ciel::shm_segment can't stat the segment");
+    }
+
+    res.size_ = static_cast<size_t>(st.st_size);
+    res.map();
+
+    if (res.size_ < sizeof(shm_arena) || !res.arena().valid(res.size_)) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::runtime_error("ciel::shm_segment the descriptor is not a segment"));
+    }
+
+    return res;
+  }
+
+  shm_segment() noexcept = default;
+
+  shm_segment(shm_segment&& other) noexcept
+      : fd_{std::exchange(other.fd_, -1)},
+        base_{std::exchange(other.base_, nullptr)},
+        size_{std::exchange(other.size_, 0)} {}
+
+  shm_segment& operator=(shm_segment&& other) noexcept {
+    if (this != std::addressof(other)) {
+      release();
+      fd_ = std::exchange(other.fd_, -1);
+      base_ = std::exchange(other.base_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+
+    return *this;
+  }
+
+  // Unmaps the segment, objects in it are not destroyed.
+  ~shm_segment() { release(); }
+
+  [[nodiscard]] int fd() const noexcept { return fd_; }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+
+  [[nodiscard]] shm_arena& arena() const noexcept { return *static_cast<shm_arena*>(base_); }
+
+  // Constructs a T in the segment and makes it the root.
+  template <class T, class... Args>
+  T& construct_root(Args&&... args) {
+    void* p = arena().allocate(sizeof(T), alignof(T));
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      T* res = ::new (p) T(std::forward<Args>(args)...);
+      arena().set_root(res);
+      return *res;
+#ifdef __cpp_exceptions
+    } catch (...) {
+      arena().deallocate(p);
+      throw;
+    }
+#endif
+  }
+
+  template <class T>
+  [[nodiscard]] T* root() const noexcept {
+    return std::launder(static_cast<T*>(arena().root()));
+  }
+
+  // Destroys the root.
+  template <class T>
+  void destroy_root() noexcept {
+    T* p = root<T>();
+    assert(p);
+
+    arena().set_root(nullptr);
+    p->~T();
+    arena().deallocate(p);
+  }
+
+};  // class shm_segment
+
+// ==================== shm_allocator ====================
+
+// Allocates from a shm_arena with offset_ptr pointers, so a vector<T, shm_allocator<T>> can itself live in the
+// segment and be used by every process mapping it, at whatever address.
+template <class T>
+class shm_allocator {
+  template <class>
+  friend class shm_allocator;
+
+  offset_ptr<shm_arena> arena_;
+
+ public:
+  using value_type = T;
+  using pointer = offset_ptr<T>;
+  using const_pointer = offset_ptr<const T>;
+  using void_pointer = offset_ptr<void>;
+  using const_void_pointer = offset_ptr<const void>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  explicit shm_allocator(shm_arena& arena) noexcept : arena_{std::addressof(arena)} {}
+
+  explicit shm_allocator(const shm_segment& segment) noexcept : shm_allocator(segment.arena()) {}
+
+  template <class U>
+  shm_allocator(const shm_allocator<U>& other) noexcept : arena_{other.arena_} {}
+
+  shm_allocator(const shm_allocator& other) noexcept = default;
+  shm_allocator& operator=(const shm_allocator& other) noexcept = default;
+
+  [[nodiscard]] pointer allocate(const size_type n) {
+    if (n > max_size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::bad_alloc{});
+    }
+
+    return pointer(static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))));
+  }
+
+  void deallocate(pointer p, size_type) noexcept { arena_->deallocate(p.get()); }
+
+  [[nodiscard]] size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+  template <class U>
+  friend bool operator==(const shm_allocator& lhs, const shm_allocator<U>& rhs) noexcept {
+    return lhs.arena_.get() == rhs.arena_.get();
+  }
+
+};  // class shm_allocator
+
+template <class T>
+using shm_vector = vector<T, shm_allocator<T>>;
+
+}  // namespace v
+}  // namespace ciel
+
+#endif
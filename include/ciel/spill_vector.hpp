@@ -0,0 +1,386 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== spill_vector ====================
+
+// A vector of trivially copyable T whose resident memory stays within a budget. Elements live in fixed-size
+// chunks; once the budget is used up, the least recently used chunk is written to an anonymous temporary file
+// and its buffer reused, and spilled chunks are read back on access. The chunk being appended to is never
+// spilled, so sequential appends only touch the file once per chunk, and for_each_chunk scans chunk by chunk.
+//
+// References returned by element access stay valid until the next call that may fault a chunk in.
+template <class T, class Allocator = std::allocator<T>>
+class spill_vector {
+  static_assert(std::is_trivially_copyable_v<T>, "spill_vector writes elements to disk as bytes.");
+  static_assert(std::is_same_v<typename Allocator::value_type, T>);
+
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+
+  static constexpr size_type default_chunk_bytes = size_type{1} << 20;
+
+ private:
+  using alloc_traits = std::allocator_traits<allocator_type>;
+  using pointer = alloc_traits::pointer;
+
+  struct chunk {
+    pointer data{nullptr};  // null while spilled
+    uint64_t last_use{0};
+    bool dirty{false};    // differs from the file
+    bool on_disk{false};  // has a copy in the file
+  };
+
+  vector<chunk> chunks_;
+  vector<size_type> resident_;  // indices of chunks with data
+  T* tail_{nullptr};            // where the next append goes, null when the last chunk needs to be prepared
+  T* tail_end_{nullptr};
+  size_type size_{0};
+  size_type chunk_size_;  // in elements
+  size_type max_resident_;
+  uint64_t clock_{0};
+  size_type spills_{0};
+  size_type faults_{0};
+  std::FILE* file_{nullptr};
+  [[no_unique_address]] allocator_type alloc_;
+
+  [[nodiscard]] size_type chunk_bytes() const noexcept { return chunk_size_ * sizeof(T); }
+
+  [[noreturn]] static void throw_errno(const char* what) {
+    CIEL_THROW_EXCEPTION(std::system_error(errno, std::generic_category(), what));
+  }
+
+  void write_chunk(const size_type index) {
+    if (file_ == nullptr) {
+      file_ = std::tmpfile();
+
+      if (file_ == nullptr) {
+        throw_errno("ciel::spill_vector can't create the spill file");
+      }
+    }
+
+    const auto* p = reinterpret_cast<const char*>(std::to_address(chunks_[index].data));
+    const off_t offset = static_cast<off_t>(index * chunk_bytes());
+
+    for (size_type done = 0; done < chunk_bytes();) {
+      const ssize_t n = ::pwrite(fileno(file_), p + done, chunk_bytes() - done, offset + done);
+
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+
+        throw_errno("ciel::spill_vector can't write the spill file");
+      }
+
+      done += n;
+    }
+  }
+
+  void read_chunk(const size_type index) {
+    auto* p = reinterpret_cast<char*>(std::to_address(chunks_[index].data));
+    const off_t offset = static_cast<off_t>(index * chunk_bytes());
+
+    for (size_type done = 0; done < chunk_bytes();) {
+      const ssize_t n = ::pread(fileno(file_), p + done, chunk_bytes() - done, offset + done);
+
+      if (n <= 0) {
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+
+        throw_errno("ciel::spill_vector can't read the spill file");
+      }
+
+      done += n;
+    }
+  }
+
+  // Returns a chunk buffer, spilling the least recently used chunk other than the last one if the budget is
+  // used up.
+  [[nodiscard]] pointer acquire_buffer() {
+    if (resident_.size() < max_resident_) {
+      return alloc_traits::allocate(alloc_, chunk_size_);
+    }
+
+    const size_type last = chunks_.size() - 1;
+    size_type victim_pos = resident_.size();
+    uint64_t victim_use = UINT64_MAX;
+
+    for (size_type i = 0; i < resident_.size(); ++i) {
+      if (resident_[i] != last && chunks_[resident_[i]].last_use < victim_use) {
+        victim_pos = i;
+        victim_use = chunks_[resident_[i]].last_use;
+      }
+    }
+
+    assert(victim_pos != resident_.size());
+
+    chunk& victim = chunks_[resident_[victim_pos]];
+
+    if (victim.dirty) {
+      write_chunk(resident_[victim_pos]);
+      victim.dirty = false;
+      victim.on_disk = true;
+      ++spills_;
+    }
+
+    resident_[victim_pos] = resident_.back();
+    resident_.pop_back();
+
+    return std::exchange(victim.data, nullptr);
+  }
+
+  void release_buffer(const size_type index) noexcept {
+    chunk& c = chunks_[index];
+
+    if (c.data) {
+      alloc_traits::deallocate(alloc_, c.data, chunk_size_);
+      c.data = nullptr;
+      resident_.erase(std::find(resident_.begin(), resident_.end(), index));
+    }
+  }
+
+  // Makes chunk index resident and returns its data.
+  [[nodiscard]] T* touch(const size_type index) {
+    chunk& c = chunks_[index];
+    c.last_use = ++clock_;
+
+    if (c.data == nullptr) [[unlikely]] {
+      assert(c.on_disk);
+
+      resident_.reserve(resident_.size() + 1);
+      pointer buffer = acquire_buffer();
+      c.data = buffer;
+
+#ifdef __cpp_exceptions
+      try {
+#endif
+        read_chunk(index);
+#ifdef __cpp_exceptions
+      } catch (...) {
+        c.data = nullptr;
+        alloc_traits::deallocate(alloc_, buffer, chunk_size_);
+        throw;
+      }
+#endif
+
+      resident_.unchecked_emplace_back(index);
+      ++faults_;
+    }
+
+    return std::to_address(c.data);
+  }
+
+  // Makes the last chunk writable for the next append, starting a new one if it's full.
+  void prepare_tail() {
+    if (size_ % chunk_size_ == 0) {
+      chunks_.reserve(chunks_.size() + 1);
+      resident_.reserve(resident_.size() + 1);
+
+      chunks_.unchecked_emplace_back();
+
+#ifdef __cpp_exceptions
+      try {
+#endif
+        chunks_.back().data = acquire_buffer();
+#ifdef __cpp_exceptions
+      } catch (...) {
+        chunks_.pop_back();
+        throw;
+      }
+#endif
+
+      chunks_.back().last_use = ++clock_;
+      resident_.unchecked_emplace_back(chunks_.size() - 1);
+      tail_ = std::to_address(chunks_.back().data);
+
+    } else {
+      tail_ = touch(chunks_.size() - 1) + size_ % chunk_size_;
+    }
+
+    tail_end_ = std::to_address(chunks_.back().data) + chunk_size_;
+    chunks_.back().dirty = true;
+  }
+
+  void swap_members(spill_vector& other) noexcept {
+    using std::swap;
+
+    swap(chunks_, other.chunks_);
+    swap(resident_, other.resident_);
+    swap(tail_, other.tail_);
+    swap(tail_end_, other.tail_end_);
+    swap(size_, other.size_);
+    swap(chunk_size_, other.chunk_size_);
+    swap(max_resident_, other.max_resident_);
+    swap(clock_, other.clock_);
+    swap(spills_, other.spills_);
+    swap(faults_, other.faults_);
+    swap(file_, other.file_);
+    swap(alloc_, other.alloc_);
+  }
+
+ public:
+  // At most memory_budget bytes of elements are resident, but never less than two chunks.
+  explicit spill_vector(const size_type memory_budget, const size_type chunk_bytes = default_chunk_bytes,
+                        const allocator_type& alloc = allocator_type())
+      : chunk_size_(std::max<size_type>(chunk_bytes / sizeof(T), 1)),
+        max_resident_(std::max<size_type>(memory_budget / (chunk_size_ * sizeof(T)), 2)),
+        alloc_(alloc) {}
+
+  spill_vector(const spill_vector&) = delete;
+  spill_vector& operator=(const spill_vector&) = delete;
+
+  spill_vector(spill_vector&& other) noexcept
+      : chunks_(std::move(other.chunks_)),
+        resident_(std::move(other.resident_)),
+        tail_{std::exchange(other.tail_, nullptr)},
+        tail_end_{std::exchange(other.tail_end_, nullptr)},
+        size_{std::exchange(other.size_, 0)},
+        chunk_size_{other.chunk_size_},
+        max_resident_{other.max_resident_},
+        clock_{other.clock_},
+        spills_{other.spills_},
+        faults_{other.faults_},
+        file_{std::exchange(other.file_, nullptr)},
+        alloc_(other.alloc_) {}
+
+  spill_vector& operator=(spill_vector&& other) noexcept {
+    spill_vector(std::move(other)).swap_members(*this);
+    return *this;
+  }
+
+  ~spill_vector() {
+    clear();
+
+    if (file_) {
+      std::fclose(file_);
+    }
+  }
+
+  allocator_type get_allocator() const noexcept { return alloc_; }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  [[nodiscard]] size_type size() const noexcept { return size_; }
+
+  // Number of elements per chunk.
+  [[nodiscard]] size_type chunk_size() const noexcept { return chunk_size_; }
+
+  [[nodiscard]] size_type max_resident_chunks() const noexcept { return max_resident_; }
+
+  [[nodiscard]] size_type resident_chunks() const noexcept { return resident_.size(); }
+
+  // Number of chunks written to and read back from the spill file so far.
+  [[nodiscard]] size_type spill_count() const noexcept { return spills_; }
+
+  [[nodiscard]] size_type fault_count() const noexcept { return faults_; }
+
+  void push_back(const T& value) { emplace_back(value); }
+
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    if (tail_ == tail_end_) [[unlikely]] {
+      prepare_tail();
+    }
+
+    T& res = *std::construct_at(tail_, std::forward<Args>(args)...);
+    ++tail_;
+    ++size_;
+
+    return res;
+  }
+
+  void pop_back() noexcept {
+    assert(!empty());
+
+    --size_;
+
+    if (size_ % chunk_size_ == 0) {
+      release_buffer(chunks_.size() - 1);
+      chunks_.pop_back();
+      tail_ = nullptr;
+      tail_end_ = nullptr;
+
+    } else if (tail_) {
+      --tail_;
+    }
+  }
+
+  // Marks the element's chunk as modified, so that it's written back when spilled.
+  [[nodiscard]] T& operator[](const size_type pos) {
+    assert(pos < size());
+
+    T* data = touch(pos / chunk_size_);
+    chunks_[pos / chunk_size_].dirty = true;
+    return data[pos % chunk_size_];
+  }
+
+  // Read only access, spilling the chunk later doesn't need to write it.
+  [[nodiscard]] const T& get(const size_type pos) {
+    assert(pos < size());
+
+    return touch(pos / chunk_size_)[pos % chunk_size_];
+  }
+
+  [[nodiscard]] T& at(const size_type pos) {
+    if (pos >= size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::spill_vector::at pos is not within the range"));
+    }
+
+    return (*this)[pos];
+  }
+
+  // Calls f with a std::span<const T> of each chunk in order.
+  template <class F>
+  void for_each_chunk(F&& f) {
+    for (size_type i = 0; i < chunks_.size(); ++i) {
+      const size_type count = i + 1 == chunks_.size() ? size_ - i * chunk_size_ : chunk_size_;
+      f(std::span<const T>(touch(i), count));
+    }
+  }
+
+  // Releases every chunk. The spill file is kept for reuse.
+  void clear() noexcept {
+    for (const size_type index : resident_) {
+      alloc_traits::deallocate(alloc_, chunks_[index].data, chunk_size_);
+    }
+
+    resident_.clear();
+    chunks_.clear();
+    tail_ = nullptr;
+    tail_end_ = nullptr;
+    size_ = 0;
+  }
+
+};  // class spill_vector
+
+}  // namespace v
+}  // namespace ciel
+
+#endif
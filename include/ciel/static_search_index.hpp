@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Inspired by the S+ tree of https://en.algorithmica.org/hpc/data-structures/s-tree/
+
+namespace ciel {
+inline namespace v {
+
+// ==================== static_search_index ====================
+
+// A read-only search index over sorted integers, laid out as an implicit B+ tree (S+ tree).
+// Each node is one cache line of B keys and has B + 1 children, which are found by index arithmetic.
+// The leaf layer is the sorted keys themselves, so the result of a search is directly the rank in the
+// original sorted sequence, and all layers live in one 64-byte aligned allocation.
+//
+// Compared to std::lower_bound, a lookup touches one cache line per layer instead of one per comparison,
+// and the keys of a node are compared at once with SIMD when available.
+template <std::integral T, class Allocator = std::allocator<T>>
+class static_search_index {
+  static_assert(std::is_same_v<typename Allocator::value_type, T>);
+
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+
+  static constexpr size_type node_bytes = 64;
+  static constexpr size_type node_size = node_bytes / sizeof(value_type);
+
+ private:
+  static constexpr size_type max_height = 32;
+  static constexpr value_type sentinel = std::numeric_limits<value_type>::max();
+
+  vector<value_type, allocator_type> storage_;
+  size_type tree_offset_{0};  // index of the first leaf key in storage_, for 64-byte alignment
+  size_type size_{0};
+  size_type height_{0};
+  std::array<size_type, max_height> layer_offsets_{};  // relative to the first leaf key, layer 0 is the leaves
+
+  [[nodiscard]] const value_type* tree() const noexcept { return storage_.data() + tree_offset_; }
+
+  [[nodiscard]] static size_type ceil_div(const size_type x, const size_type y) noexcept { return (x + y - 1) / y; }
+
+  // Number of keys in node that are less than x.
+  [[nodiscard]] static size_type count_less(const value_type* node, const value_type x) noexcept {
+    assert(reinterpret_cast<uintptr_t>(node) % node_bytes == 0);
+
+#if defined(__AVX2__)
+    if constexpr (sizeof(value_type) == 4 || sizeof(value_type) == 8) {
+      // AVX2 only has signed comparisons, flipping the sign bit maps unsigned order onto signed order.
+      constexpr value_type flip = std::is_unsigned_v<value_type> ? value_type(1) << (sizeof(value_type) * 8 - 1) : 0;
+
+      size_type res = 0;
+      for (size_type i = 0; i < node_bytes; i += 32) {
+        const __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i*>(node) + i / 32);
+
+        if constexpr (sizeof(value_type) == 4) {
+          const __m256i xs = _mm256_set1_epi32(static_cast<int>(x ^ flip));
+          const __m256i less = _mm256_cmpgt_epi32(xs, _mm256_xor_si256(keys, _mm256_set1_epi32(static_cast<int>(flip))));
+          res += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(less))));
+
+        } else {
+          const __m256i xs = _mm256_set1_epi64x(static_cast<long long>(x ^ flip));
+          const __m256i less =
+              _mm256_cmpgt_epi64(xs, _mm256_xor_si256(keys, _mm256_set1_epi64x(static_cast<long long>(flip))));
+          res += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(less))));
+        }
+      }
+
+      return res;
+    }
+#elif defined(__SSE2__)
+    if constexpr (sizeof(value_type) == 4) {
+      constexpr value_type flip = std::is_unsigned_v<value_type> ? value_type(1) << 31 : 0;
+
+      const __m128i xs = _mm_set1_epi32(static_cast<int>(x ^ flip));
+      const __m128i flips = _mm_set1_epi32(static_cast<int>(flip));
+
+      size_type res = 0;
+      for (size_type i = 0; i < node_bytes; i += 16) {
+        const __m128i keys = _mm_load_si128(reinterpret_cast<const __m128i*>(node) + i / 16);
+        const __m128i less = _mm_cmpgt_epi32(xs, _mm_xor_si128(keys, flips));
+        res += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(less))));
+      }
+
+      return res;
+    }
+#endif
+
+    // Branchless, so compilers can vectorize it.
+    size_type res = 0;
+    for (size_type i = 0; i < node_size; ++i) {
+      res += static_cast<size_type>(node[i] < x);
+    }
+
+    return res;
+  }
+
+  void build() {
+    assert(std::is_sorted(storage_.begin() + tree_offset_, storage_.end()));
+
+    // Pad the leaf layer to whole nodes.
+    size_type nodes = ceil_div(size_, node_size);
+    storage_.insert(storage_.end(), nodes * node_size - size_, sentinel);
+
+    layer_offsets_[0] = 0;
+    height_ = 1;
+
+    // Key j of node k in layer h is the smallest key of its child k * (B + 1) + j + 1,
+    // found by always descending to the leftmost child.
+    size_type leftmost_factor = 1;  // (B + 1) ^ (h - 1)
+
+    while (nodes > 1) {
+      assert(height_ < max_height);
+
+      nodes = ceil_div(nodes, node_size + 1);
+      layer_offsets_[height_] = storage_.size() - tree_offset_;
+
+      for (size_type k = 0; k < nodes; ++k) {
+        for (size_type j = 0; j < node_size; ++j) {
+          const size_type pos = (k * (node_size + 1) + j + 1) * leftmost_factor * node_size;
+          storage_.unchecked_emplace_back(pos < size_ ? tree()[pos] : sentinel);
+        }
+      }
+
+      leftmost_factor *= node_size + 1;
+      ++height_;
+    }
+  }
+
+  [[nodiscard]] static size_type storage_size(const size_type n) noexcept {
+    size_type nodes = ceil_div(n, node_size);
+    size_type res = nodes;
+
+    while (nodes > 1) {
+      nodes = ceil_div(nodes, node_size + 1);
+      res += nodes;
+    }
+
+    // Plus one node of slack for the alignment.
+    return (res + 1) * node_size;
+  }
+
+ public:
+  static_search_index() = default;
+
+  // Builds the index from sorted keys in O(n), with a single allocation.
+  template <std::ranges::forward_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, value_type>
+  explicit static_search_index(const R& sorted, const allocator_type& alloc = allocator_type())
+      : storage_(alloc), size_(static_cast<size_type>(std::ranges::distance(sorted))) {
+    if (size_ == 0) {
+      return;
+    }
+
+    storage_.reserve(storage_size(size_));
+
+    const auto address = reinterpret_cast<uintptr_t>(storage_.data());
+    tree_offset_ = (node_bytes - address % node_bytes) % node_bytes / sizeof(value_type);
+    storage_.insert(storage_.end(), tree_offset_, value_type{});
+    storage_.insert(storage_.end(), std::ranges::begin(sorted), std::ranges::end(sorted));
+
+    build();
+    assert(storage_.size() <= storage_size(size_));
+  }
+
+  // Copying rebuilds the index, since the copy may not be aligned the same way.
+  static_search_index(const static_search_index& other)
+      : static_search_index(other.keys(),
+                            std::allocator_traits<allocator_type>::select_on_container_copy_construction(
+                                other.get_allocator())) {}
+
+  static_search_index(static_search_index&& other) noexcept
+      : storage_(std::move(other.storage_)),
+        tree_offset_{std::exchange(other.tree_offset_, 0)},
+        size_{std::exchange(other.size_, 0)},
+        height_{std::exchange(other.height_, 0)},
+        layer_offsets_{other.layer_offsets_} {}
+
+  static_search_index& operator=(const static_search_index& other) {
+    if (this != std::addressof(other)) {
+      static_search_index(other).swap(*this);
+    }
+
+    return *this;
+  }
+
+  static_search_index& operator=(static_search_index&& other) noexcept {
+    static_search_index(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return storage_.get_allocator(); }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  [[nodiscard]] size_type size() const noexcept { return size_; }
+
+  [[nodiscard]] size_type height() const noexcept { return height_; }
+
+  // The sorted keys, i.e. the leaf layer.
+  [[nodiscard]] std::span<const value_type> keys() const noexcept {
+    return size_ == 0 ? std::span<const value_type>{} : std::span<const value_type>(tree(), size_);
+  }
+
+  [[nodiscard]] value_type operator[](const size_type rank) const noexcept {
+    assert(rank < size_);
+
+    return tree()[rank];
+  }
+
+  // Rank of the first key that is not less than x, or size() if there is none.
+  [[nodiscard]] size_type lower_bound(const value_type x) const noexcept {
+    if (size_ == 0) {
+      return 0;
+    }
+
+    const value_type* t = tree();
+    size_type k = 0;
+
+    for (size_type h = height_ - 1; h > 0; --h) {
+      k = k * (node_size + 1) + count_less(t + layer_offsets_[h] + k * node_size, x);
+    }
+
+    return std::min(k * node_size + count_less(t + k * node_size, x), size_);
+  }
+
+  // Rank of the first key that is greater than x, or size() if there is none.
+  [[nodiscard]] size_type upper_bound(const value_type x) const noexcept {
+    return x == sentinel ? size_ : lower_bound(x + 1);
+  }
+
+  [[nodiscard]] bool contains(const value_type x) const noexcept {
+    const size_type rank = lower_bound(x);
+    return rank != size_ && tree()[rank] == x;
+  }
+
+  // Batched lower_bound, out[i] = lower_bound(xs[i]). Queries are processed in groups that descend the
+  // tree together, and the next node of each query is prefetched, so that the cache misses of different
+  // queries overlap.
+  void lower_bound(std::span<const value_type> xs, std::span<size_type> out) const noexcept {
+    assert(xs.size() <= out.size());
+
+    if (size_ == 0) {
+      std::fill_n(out.begin(), xs.size(), 0);
+      return;
+    }
+
+    constexpr size_type group = 16;
+    const value_type* t = tree();
+
+    for (size_type first = 0; first < xs.size(); first += group) {
+      const size_type count = std::min(group, xs.size() - first);
+      std::array<size_type, group> ks{};
+
+      for (size_type h = height_ - 1; h > 0; --h) {
+        for (size_type q = 0; q < count; ++q) {
+          ks[q] = ks[q] * (node_size + 1) + count_less(t + layer_offsets_[h] + ks[q] * node_size, xs[first + q]);
+#if defined(__GNUC__) || __has_builtin(__builtin_prefetch)
+          __builtin_prefetch(t + layer_offsets_[h - 1] + ks[q] * node_size);
+#endif
+        }
+      }
+
+      for (size_type q = 0; q < count; ++q) {
+        out[first + q] = std::min(ks[q] * node_size + count_less(t + ks[q] * node_size, xs[first + q]), size_);
+      }
+    }
+  }
+
+  void swap(static_search_index& other) noexcept {
+    storage_.swap(other.storage_);
+    std::swap(tree_offset_, other.tree_offset_);
+    std::swap(size_, other.size_);
+    std::swap(height_, other.height_);
+    std::swap(layer_offsets_, other.layer_offsets_);
+  }
+
+};  // class static_search_index
+
+template <class T, class Allocator>
+struct is_trivially_relocatable<static_search_index<T, Allocator>>
+    : is_trivially_relocatable<vector<T, Allocator>> {};
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class T, class Alloc>
+void swap(ciel::static_search_index<T, Alloc>& lhs, ciel::static_search_index<T, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ciel {
+inline namespace v {
+
+// ==================== string_vector ====================
+
+// A sequence of strings whose characters are stored back to back in one char vector, with the end
+// offset of each string in a second vector. String i spans [ends[i - 1], ends[i]).
+// Compared to vector<std::string>, there is no per-string allocation or small string buffer.
+//
+// Offset can be narrowed to uint32_t when the total number of characters stays below 4 GiB.
+template <class Offset = size_t, class Allocator = std::allocator<char>>
+class string_vector {
+  static_assert(std::is_unsigned_v<Offset>);
+  static_assert(std::is_same_v<typename Allocator::value_type, char>);
+
+ public:
+  using value_type = std::string_view;
+  using offset_type = Offset;
+  using allocator_type = Allocator;
+  using chars_type = vector<char, allocator_type>;
+  using offsets_type =
+      vector<offset_type, typename std::allocator_traits<allocator_type>::template rebind_alloc<offset_type>>;
+  using size_type = chars_type::size_type;
+  using difference_type = chars_type::difference_type;
+  using reference = std::string_view;
+  using const_reference = std::string_view;
+
+  class const_iterator;
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+ private:
+  chars_type chars_;
+  offsets_type ends_;
+
+  static constexpr size_type max_offset = std::numeric_limits<offset_type>::max();
+
+  void check_offset(const size_type new_chars_size) const {
+    if (new_chars_size > max_offset) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::length_error("ciel::string_vector total size is beyond offset_type's range"));
+    }
+  }
+
+  [[nodiscard]] size_type begin_offset(const size_type pos) const noexcept { return pos == 0 ? 0 : ends_[pos - 1]; }
+
+ public:
+  string_vector() = default;
+
+  explicit string_vector(const allocator_type& alloc) : chars_(alloc), ends_(alloc) {}
+
+  template <std::ranges::input_range R>
+    requires(!std::same_as<std::remove_cvref_t<R>, string_vector>) &&
+            std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+  explicit string_vector(R&& r, const allocator_type& alloc = allocator_type()) : string_vector(alloc) {
+    append(std::forward<R>(r));
+  }
+
+  string_vector(std::initializer_list<std::string_view> ilist, const allocator_type& alloc = allocator_type())
+      : string_vector(alloc) {
+    append(ilist);
+  }
+
+  allocator_type get_allocator() const noexcept { return chars_.get_allocator(); }
+
+  [[nodiscard]] const_reference at(const size_type pos) const {
+    if (pos >= size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::out_of_range("ciel::string_vector::at pos is not within the range"));
+    }
+
+    return (*this)[pos];
+  }
+
+  [[nodiscard]] const_reference operator[](const size_type pos) const noexcept {
+    assert(pos < size());
+
+    const size_type first = begin_offset(pos);
+    return std::string_view(chars_.data() + first, ends_[pos] - first);
+  }
+
+  [[nodiscard]] const_reference front() const noexcept { return (*this)[0]; }
+
+  [[nodiscard]] const_reference back() const noexcept { return (*this)[size() - 1]; }
+
+  // All characters of all strings.
+  [[nodiscard]] std::span<const char> chars() const noexcept { return {chars_.data(), chars_.size()}; }
+
+  [[nodiscard]] std::span<const offset_type> ends() const noexcept { return {ends_.data(), ends_.size()}; }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(this, 0); }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] const_iterator end() const noexcept { return const_iterator(this, size()); }
+
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+  [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+
+  [[nodiscard]] const_reverse_iterator crend() const noexcept { return rend(); }
+
+  [[nodiscard]] bool empty() const noexcept { return ends_.empty(); }
+
+  [[nodiscard]] size_type size() const noexcept { return ends_.size(); }
+
+  [[nodiscard]] size_type chars_size() const noexcept { return chars_.size(); }
+
+  void reserve(const size_type new_count, const size_type new_chars) {
+    ends_.reserve(new_count);
+    chars_.reserve(new_chars);
+  }
+
+  void shrink_to_fit() {
+    ends_.shrink_to_fit();
+    chars_.shrink_to_fit();
+  }
+
+  void clear() noexcept {
+    ends_.clear();
+    chars_.clear();
+  }
+
+  std::string_view emplace_back(const std::string_view s) {
+    const size_type first = chars_.size();
+    check_offset(first + s.size());
+
+    chars_.insert(chars_.end(), s.begin(), s.end());
+
+#ifdef __cpp_exceptions
+    try {
+#endif
+      ends_.emplace_back(static_cast<offset_type>(chars_.size()));
+#ifdef __cpp_exceptions
+    } catch (...) {
+      chars_.erase(chars_.begin() + first, chars_.end());
+      throw;
+    }
+#endif
+
+    return std::string_view(chars_.data() + first, s.size());
+  }
+
+  void push_back(const std::string_view s) { emplace_back(s); }
+
+  // Appends all strings of r. The total size is computed in a separate pass when r is a forward range,
+  // so both vectors grow at most once.
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+  void append(R&& r) {
+    if constexpr (std::ranges::forward_range<R>) {
+      size_type count = 0;
+      size_type total = 0;
+
+      for (auto&& e : r) {
+        ++count;
+        total += std::string_view(e).size();
+      }
+
+      check_offset(chars_.size() + total);
+
+      if (chars_.capacity() < chars_.size() + total) {
+        chars_.reserve(std::max(chars_.capacity() * 2, chars_.size() + total));
+      }
+      if (ends_.capacity() < ends_.size() + count) {
+        ends_.reserve(std::max(ends_.capacity() * 2, ends_.size() + count));
+      }
+
+      for (auto&& e : r) {
+        const std::string_view s(e);
+        chars_.insert(chars_.end(), s.begin(), s.end());
+        ends_.unchecked_emplace_back(static_cast<offset_type>(chars_.size()));
+      }
+
+    } else {
+      for (auto&& e : r) {
+        emplace_back(std::string_view(e));
+      }
+    }
+  }
+
+  void pop_back() noexcept {
+    assert(!empty());
+
+    ends_.pop_back();
+    chars_.erase(chars_.begin() + (ends_.empty() ? 0 : ends_.back()), chars_.end());
+  }
+
+  void swap(string_vector& other) noexcept {
+    chars_.swap(other.chars_);
+    ends_.swap(other.ends_);
+  }
+
+  // ==================== const_iterator ====================
+
+  class const_iterator {
+   public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;  // operator* returns by value
+    using value_type = std::string_view;
+    using difference_type = ptrdiff_t;
+    using reference = std::string_view;
+
+   private:
+    const string_vector* c_{nullptr};
+    size_type index_{0};
+
+    friend class string_vector;
+
+    const_iterator(const string_vector* c, const size_type index) noexcept : c_{c}, index_{index} {}
+
+   public:
+    const_iterator() = default;
+
+    [[nodiscard]] reference operator*() const noexcept { return (*c_)[index_]; }
+
+    [[nodiscard]] reference operator[](const difference_type n) const noexcept { return (*c_)[index_ + n]; }
+
+    const_iterator& operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+
+    const_iterator operator++(int) noexcept {
+      const_iterator res(*this);
+      ++index_;
+      return res;
+    }
+
+    const_iterator& operator--() noexcept {
+      --index_;
+      return *this;
+    }
+
+    const_iterator operator--(int) noexcept {
+      const_iterator res(*this);
+      --index_;
+      return res;
+    }
+
+    const_iterator& operator+=(const difference_type n) noexcept {
+      index_ += n;
+      return *this;
+    }
+
+    const_iterator& operator-=(const difference_type n) noexcept {
+      index_ -= n;
+      return *this;
+    }
+
+    [[nodiscard]] friend const_iterator operator+(const_iterator it, const difference_type n) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend const_iterator operator+(const difference_type n, const_iterator it) noexcept {
+      return it += n;
+    }
+
+    [[nodiscard]] friend const_iterator operator-(const_iterator it, const difference_type n) noexcept {
+      return it -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator-(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+      return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    [[nodiscard]] friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+      return lhs.index_ == rhs.index_;
+    }
+
+    [[nodiscard]] friend std::strong_ordering operator<=>(const const_iterator& lhs,
+                                                          const const_iterator& rhs) noexcept {
+      return lhs.index_ <=> rhs.index_;
+    }
+
+  };  // class const_iterator
+
+};  // class string_vector
+
+template <class Offset, class Allocator>
+struct is_trivially_relocatable<string_vector<Offset, Allocator>>
+    : std::conjunction<is_trivially_relocatable<typename string_vector<Offset, Allocator>::chars_type>,
+                       is_trivially_relocatable<typename string_vector<Offset, Allocator>::offsets_type>> {};
+
+template <class Offset, class Alloc>
+bool operator==(const string_vector<Offset, Alloc>& lhs, const string_vector<Offset, Alloc>& rhs) {
+  return std::ranges::equal(lhs.ends(), rhs.ends()) && std::ranges::equal(lhs.chars(), rhs.chars());
+}
+
+}  // namespace v
+}  // namespace ciel
+
+namespace std {
+
+template <class Offset, class Alloc>
+void swap(ciel::string_vector<Offset, Alloc>& lhs, ciel::string_vector<Offset, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace std
@@ -7,10 +7,15 @@
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <scoped_allocator>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
 
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
 // Inspired by LLVM libc++ and folly's implementation.
 
 namespace ciel {
@@ -69,12 +74,37 @@ struct allocator_has_destroy<Alloc, Pointer,
 // allocator_has_trivial_construct
 // allocator_has_trivial_destroy
 // Note that Pointer type may not be same as the pointer to typename Alloc::value_type.
+//
+// When they hold, vector copies, relocates and destroys elements with memcpy and memmove instead of going through
+// the allocator. By default that's when the allocator has no construct or destroy. An allocator whose construct and
+// destroy have no effect beyond placement new and the destructor, e.g. logging ones, can say so with
+//
+//   using has_trivial_construct = std::true_type;
+//   using has_trivial_destroy = std::true_type;
+//
+// or these traits can be specialized for it, as for std::allocator below.
+
+template <class Alloc, class Default, class = void>
+struct allocator_declares_trivial_construct : Default {};
+
+template <class Alloc, class Default>
+struct allocator_declares_trivial_construct<Alloc, Default, std::void_t<typename Alloc::has_trivial_construct>>
+    : std::bool_constant<Alloc::has_trivial_construct::value> {};
+
+template <class Alloc, class Default, class = void>
+struct allocator_declares_trivial_destroy : Default {};
+
+template <class Alloc, class Default>
+struct allocator_declares_trivial_destroy<Alloc, Default, std::void_t<typename Alloc::has_trivial_destroy>>
+    : std::bool_constant<Alloc::has_trivial_destroy::value> {};
 
 template <class Alloc, class Pointer, class... Args>
-struct allocator_has_trivial_construct : std::negation<allocator_has_construct<Alloc, Pointer, Args...>> {};
+struct allocator_has_trivial_construct
+    : allocator_declares_trivial_construct<Alloc, std::negation<allocator_has_construct<Alloc, Pointer, Args...>>> {};
 
 template <class Alloc, class Pointer>
-struct allocator_has_trivial_destroy : std::negation<allocator_has_destroy<Alloc, Pointer>> {};
+struct allocator_has_trivial_destroy
+    : allocator_declares_trivial_destroy<Alloc, std::negation<allocator_has_destroy<Alloc, Pointer>>> {};
 
 // specializations for std::allocator
 
@@ -84,8 +114,130 @@ struct allocator_has_trivial_construct<std::allocator<T>, Pointer, Args...> : st
 template <class T, class Pointer>
 struct allocator_has_trivial_destroy<std::allocator<T>, Pointer> : std::true_type {};
 
+// allocator_has_trivial_relocate
+// Whether vector can relocate trivially relocatable elements within its storage, on growth, insertion and erasure,
+// with memcpy and memmove. By default that's when moving into place and destroying are trivial, but it also holds
+// for allocators whose construct only passes the elements an allocator they already have.
+
+template <class Alloc, class Pointer>
+struct allocator_has_trivial_relocate
+    : std::conjunction<
+          allocator_has_trivial_construct<Alloc, Pointer, typename std::pointer_traits<Pointer>::element_type&&>,
+          allocator_has_trivial_destroy<Alloc, Pointer>> {};
+
+template <class Pointer>
+using pointee_t = std::remove_cv_t<typename std::pointer_traits<Pointer>::element_type>;
+
+template <class T>
+struct is_std_pair : std::false_type {};
+
+template <class T1, class T2>
+struct is_std_pair<std::pair<T1, T2>> : std::true_type {};
+
+// Uses-allocator construction of T with Alloc is a plain placement new unless T takes an allocator, directly or as
+// a std::pair of such objects.
+template <class T, class Alloc>
+struct is_plain_uses_allocator_construction
+    : std::bool_constant<!std::uses_allocator_v<T, Alloc> && !is_std_pair<T>::value> {};
+
+// specializations for std::scoped_allocator_adaptor
+// construct is the outer allocator's, with the inner allocator added for objects taking one. Elements of a vector
+// were constructed with the inner allocator already, so relocating them is trivial as long as it's trivial for
+// the outer allocator, e.g. the inner vectors of a vector of vectors are moved with memcpy on growth. A relocated
+// element keeps its own allocator, which only differs from the inner allocator if it was assigned one.
+
+template <class Outer, class... Inner, class Pointer, class... Args>
+struct allocator_has_trivial_construct<std::scoped_allocator_adaptor<Outer, Inner...>, Pointer, Args...>
+    : std::conjunction<
+          is_plain_uses_allocator_construction<
+              pointee_t<Pointer>, typename std::scoped_allocator_adaptor<Outer, Inner...>::inner_allocator_type>,
+          allocator_has_trivial_construct<Outer, Pointer, Args...>> {};
+
+template <class Outer, class... Inner, class Pointer>
+struct allocator_has_trivial_destroy<std::scoped_allocator_adaptor<Outer, Inner...>, Pointer>
+    : allocator_has_trivial_destroy<Outer, Pointer> {};
+
+template <class Outer, class... Inner, class Pointer>
+struct allocator_has_trivial_relocate<std::scoped_allocator_adaptor<Outer, Inner...>, Pointer>
+    : allocator_has_trivial_relocate<Outer, Pointer> {};
+
+#ifdef __cpp_lib_memory_resource
+
+// specializations for std::pmr::polymorphic_allocator
+// Its construct is uses-allocator construction, and elements already hold its memory resource, as for
+// std::scoped_allocator_adaptor above.
+
+template <class T, class Pointer, class... Args>
+struct allocator_has_trivial_construct<std::pmr::polymorphic_allocator<T>, Pointer, Args...>
+    : is_plain_uses_allocator_construction<pointee_t<Pointer>, std::pmr::polymorphic_allocator<T>> {};
+
+template <class T, class Pointer>
+struct allocator_has_trivial_destroy<std::pmr::polymorphic_allocator<T>, Pointer> : std::true_type {};
+
+template <class T, class Pointer>
+struct allocator_has_trivial_relocate<std::pmr::polymorphic_allocator<T>, Pointer> : std::true_type {};
+
+#endif
+
+// allocator_capacity_granularity
+// An allocator can declare a static constexpr capacity_granularity member, then every allocation made by vector
+// is rounded up to a multiple of it, e.g. to whole SIMD lanes.
+
+template <class Alloc, class = void>
+struct allocator_capacity_granularity : std::integral_constant<size_t, 1> {};
+
+template <class Alloc>
+struct allocator_capacity_granularity<Alloc, std::void_t<decltype(Alloc::capacity_granularity)>>
+    : std::integral_constant<size_t, Alloc::capacity_granularity> {};
+
+template <class Alloc>
+[[nodiscard]] constexpr size_t round_up_capacity(const size_t count) noexcept {
+  constexpr size_t granularity = allocator_capacity_granularity<Alloc>::value;
+  static_assert(granularity != 0);
+
+  if constexpr (granularity == 1) {
+    return count;
+
+  } else {
+    return (count + granularity - 1) / granularity * granularity;
+  }
+}
+
+// allocator_has_expand_in_place
+// An allocator can provide bool expand_in_place(pointer p, size_type old_n, size_type new_n), which tries to grow
+// the allocation at p from old_n to new_n objects without moving it. vector tries it before reallocating,
+// so growth neither copies elements nor invalidates references.
+
+template <class Alloc, class = void>
+struct allocator_has_expand_in_place : std::false_type {};
+
+template <class Alloc>
+struct allocator_has_expand_in_place<
+    Alloc, std::void_t<decltype(std::declval<Alloc&>().expand_in_place(
+               std::declval<typename std::allocator_traits<Alloc>::pointer>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// allocator_has_allocate_zeroed
+// An allocator can provide pointer allocate_zeroed(size_type n), which allocates like allocate with every byte zero,
+// e.g. with calloc, whose large blocks are fresh pages from mmap. Elements value-initialized in such a buffer are
+// then only counted, not written, so their pages are faulted in on first use.
+
+template <class Alloc, class = void>
+struct allocator_has_allocate_zeroed : std::false_type {};
+
+template <class Alloc>
+struct allocator_has_allocate_zeroed<Alloc, std::void_t<decltype(std::declval<Alloc&>().allocate_zeroed(size_t{}))>>
+    : std::true_type {};
+
 // ==================== uninitialized_copy ====================
 
+// Allocator pointers point into contiguous storage even when they are fancy pointers that only claim
+// random access, so they are memcpy-able through std::to_address as well.
+template <class Alloc, class Iter>
+inline constexpr bool is_contiguous_iterator_v =
+    std::contiguous_iterator<Iter> || std::is_same_v<Iter, typename std::allocator_traits<Alloc>::pointer> ||
+    std::is_same_v<Iter, typename std::allocator_traits<Alloc>::const_pointer>;
+
 template <class Alloc, class InputIt, class OutputIt>
 constexpr void uninitialized_copy(Alloc& alloc, InputIt first, InputIt last, OutputIt& result) {
   using T = std::iterator_traits<InputIt>::value_type;
@@ -95,8 +247,9 @@ constexpr void uninitialized_copy(Alloc& alloc, InputIt first, InputIt last, Out
     constexpr bool via_trivial_construct = allocator_has_trivial_construct<
         Alloc, decltype(std::to_address(std::declval<typename std::allocator_traits<Alloc>::pointer>())),
         decltype(*std::declval<InputIt>())>::value;
-    if constexpr (via_trivial_construct && std::contiguous_iterator<InputIt> && std::contiguous_iterator<OutputIt> &&
-                  std::is_same_v<T, U> && std::is_trivially_copy_constructible_v<T>) {
+    if constexpr (via_trivial_construct && is_contiguous_iterator_v<Alloc, InputIt> &&
+                  is_contiguous_iterator_v<Alloc, OutputIt> && std::is_same_v<T, U> &&
+                  std::is_trivially_copy_constructible_v<T>) {
       if constexpr (std::is_convertible_v<decltype(std::to_address(first)), const void*> &&
                     std::is_convertible_v<decltype(std::to_address(result)), void*>) {
         const size_t count = std::distance(first, last);
@@ -187,9 +340,30 @@ struct is_trivially_relocatable<std::pair<First, Second>>
 template <class... Types>
 struct is_trivially_relocatable<std::tuple<Types...>> : std::conjunction<is_trivially_relocatable<Types>...> {};
 
+// std::allocator is empty, even where its user-provided copy constructor makes it not trivially copyable.
+template <class T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+template <class Outer, class... Inner>
+struct is_trivially_relocatable<std::scoped_allocator_adaptor<Outer, Inner...>>
+    : std::conjunction<is_trivially_relocatable<Outer>, is_trivially_relocatable<Inner>...> {};
+
 template <class T>
 inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
 
+// ==================== is_zero_initializable ====================
+
+// Whether a value-initialized T is all zero bytes. That holds for arithmetic, enumeration and pointer types, but not
+// for pointers to data members on common ABIs. It can be specialized, e.g. for structs of such types.
+
+template <class T>
+struct is_zero_initializable
+    : std::bool_constant<std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T> ||
+                         std::is_null_pointer_v<T>> {};
+
+template <class T>
+inline constexpr bool is_zero_initializable_v = is_zero_initializable<T>::value;
+
 // ==================== move_if_noexcept ====================
 
 template <class T>
@@ -281,8 +455,24 @@ class split_buffer {
     assert(cap != 0);
     assert(cap >= offset);
 
-    begin_cap_ = std::allocator_traits<allocator_type>::allocate(allocator_ref_, cap);
-    end_cap_ = begin_cap_ + cap;
+    const size_type rounded_cap = ciel::v::round_up_capacity<allocator_type>(cap);
+    begin_cap_ = std::allocator_traits<allocator_type>::allocate(allocator_ref_, rounded_cap);
+    end_cap_ = begin_cap_ + rounded_cap;
+    begin_ = begin_cap_ + offset;
+    end_ = begin_;
+  }
+
+  struct zeroed_t {};
+
+  // Same as above with allocate_zeroed.
+  constexpr split_buffer(AllocatorReference alloc, const size_type cap, const size_type offset, zeroed_t)
+      : allocator_ref_(alloc) {
+    assert(cap != 0);
+    assert(cap >= offset);
+
+    const size_type rounded_cap = ciel::v::round_up_capacity<allocator_type>(cap);
+    begin_cap_ = allocator_ref_.allocate_zeroed(rounded_cap);
+    end_cap_ = begin_cap_ + rounded_cap;
     begin_ = begin_cap_ + offset;
     end_ = begin_;
   }
@@ -351,6 +541,13 @@ class vector {
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+  // A buffer handed over by into_raw_parts, or to adopt.
+  struct raw_parts {
+    pointer data;
+    size_type size;
+    size_type capacity;
+  };
+
  private:
   template <class... Args>
   static constexpr bool via_trivial_construct =
@@ -358,14 +555,22 @@ class vector {
                                       Args...>::value;
   static constexpr bool via_trivial_destroy =
       allocator_has_trivial_destroy<allocator_type, decltype(std::to_address(std::declval<pointer>()))>::value;
+  static constexpr bool via_trivial_relocate =
+      allocator_has_trivial_relocate<allocator_type, decltype(std::to_address(std::declval<pointer>()))>::value;
+
+  // Value-initialized elements in a buffer from allocate_zeroed are already there.
+  static constexpr bool value_init_via_zeroed = allocator_has_allocate_zeroed<allocator_type>::value &&
+                                                is_zero_initializable_v<value_type> && via_trivial_construct<>;
 
  public:
   static constexpr bool expand_via_memcpy =
       is_trivially_relocatable_v<value_type> &&
-      via_trivial_construct<decltype(ciel::v::move_if_noexcept(*std::declval<pointer>()))> && via_trivial_destroy;
-  static constexpr bool move_via_memmove = is_trivially_relocatable_v<value_type> &&
-                                           via_trivial_construct<decltype(std::move(*std::declval<pointer>()))> &&
-                                           via_trivial_destroy;
+      ((via_trivial_construct<decltype(ciel::v::move_if_noexcept(*std::declval<pointer>()))> && via_trivial_destroy) ||
+       via_trivial_relocate);
+  static constexpr bool move_via_memmove =
+      is_trivially_relocatable_v<value_type> &&
+      ((via_trivial_construct<decltype(std::move(*std::declval<pointer>()))> && via_trivial_destroy) ||
+       via_trivial_relocate);
 
  private:
   pointer begin_{nullptr};
@@ -398,24 +603,6 @@ class vector {
     return false;
   }
 
-  [[nodiscard]] constexpr size_type recommend_cap(const size_type new_size) const {
-    assert(new_size > 0);
-
-    const size_type ms = max_size();
-
-    if (new_size > ms) [[unlikely]] {
-      CIEL_THROW_EXCEPTION(std::length_error("ciel::vector expanding size is beyond max_size"));
-    }
-
-    const size_type cap = capacity();
-
-    if (cap >= ms / 2) [[unlikely]] {
-      return ms;
-    }
-
-    return std::max(cap * 2, new_size);
-  }
-
   template <class... Args>
   constexpr void construct(pointer p, Args&&... args) {
     std::allocator_traits<allocator_type>::construct(alloc_, std::to_address(p), std::forward<Args>(args)...);
@@ -475,11 +662,57 @@ class vector {
     assert(end_ == nullptr);
     assert(end_cap_ == nullptr);
 
-    begin_ = std::allocator_traits<allocator_type>::allocate(alloc_, count);
-    end_cap_ = begin_ + count;
+    const size_type rounded_count = ciel::v::round_up_capacity<allocator_type>(count);
+    begin_ = std::allocator_traits<allocator_type>::allocate(alloc_, rounded_count);
+    end_cap_ = begin_ + rounded_count;
     end_ = begin_;
   }
 
+  // Same as init followed by construct_at_end(count), by allocating a zeroed buffer. Returns false if the allocator
+  // or value_type doesn't allow it.
+  [[nodiscard]] constexpr bool init_value_initialized(const size_type count) {
+    if constexpr (value_init_via_zeroed) {
+      if (!std::is_constant_evaluated()) {
+        assert(count != 0);
+        assert(begin_ == nullptr);
+
+        const size_type rounded_count = ciel::v::round_up_capacity<allocator_type>(count);
+        begin_ = alloc_.allocate_zeroed(rounded_count);
+        end_cap_ = begin_ + rounded_count;
+        end_ = begin_ + count;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Grows capacity to at least new_cap without moving the buffer, if the allocator supports it.
+  [[nodiscard]] constexpr bool try_expand_in_place(const size_type new_cap) noexcept {
+    if constexpr (allocator_has_expand_in_place<allocator_type>::value) {
+      if (begin_) {
+        const size_type rounded_cap = ciel::v::round_up_capacity<allocator_type>(new_cap);
+
+        if (alloc_.expand_in_place(begin_, capacity(), rounded_cap)) {
+          end_cap_ = begin_ + rounded_cap;
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  // Same as above when growing to hold new_size elements, the capacity comes from recommend_cap.
+  [[nodiscard]] constexpr bool try_grow_in_place(const size_type new_size) {
+    if constexpr (allocator_has_expand_in_place<allocator_type>::value) {
+      return try_expand_in_place(recommend_cap(new_size));
+
+    } else {
+      return false;
+    }
+  }
+
   constexpr void reset() noexcept {
     do_destroy();
     set_nullptr();
@@ -565,7 +798,7 @@ class vector {
 
   template <class... Args>
   constexpr void emplace_back_aux(Args&&... args) {
-    if (end_ == end_cap_) {
+    if (end_ == end_cap_ && !try_grow_in_place(size() + 1)) {
       split_buffer<value_type, allocator_type&> sb(alloc_, recommend_cap(size() + 1), size());
       sb.unchecked_emplace_back(std::forward<Args>(args)...);
       swap_out_buffer(std::move(sb));
@@ -598,8 +831,10 @@ class vector {
 
   constexpr explicit vector(const size_type count, const allocator_type& alloc = allocator_type()) : vector(alloc) {
     if (count > 0) [[likely]] {
-      init(count);
-      construct_at_end(count);
+      if (!init_value_initialized(count)) {
+        init(count);
+        construct_at_end(count);
+      }
     }
   }
 
@@ -890,14 +1125,61 @@ class vector {
       CIEL_THROW_EXCEPTION(std::length_error{"ciel::vector::reserve capacity beyond max_size"});
     }
 
+    if (try_expand_in_place(new_cap)) {
+      return;
+    }
+
     split_buffer<value_type, allocator_type&> sb(alloc_, new_cap, size());
     swap_out_buffer(std::move(sb));
   }
 
   [[nodiscard]] constexpr size_type capacity() const noexcept { return end_cap_ - begin_; }
 
+  // The capacity this vector grows to when it has to hold new_size elements. Containers that build the new
+  // buffer themselves, before releasing this one, use it to grow the same way.
+  [[nodiscard]] constexpr size_type recommend_cap(const size_type new_size) const {
+    assert(new_size > 0);
+
+    const size_type ms = max_size();
+
+    if (new_size > ms) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::length_error("ciel::vector expanding size is beyond max_size"));
+    }
+
+    const size_type cap = capacity();
+
+    if (cap >= ms / 2) [[unlikely]] {
+      return ms;
+    }
+
+    return std::max(cap * 2, new_size);
+  }
+
+  // Makes room for at least count elements past end(), growing the way push_back does, so calling it before
+  // every append stays amortized O(1).
+  constexpr void reserve_spare(const size_type count) {
+    if (count <= static_cast<size_type>(end_cap_ - end_)) {
+      return;
+    }
+
+    if (count > max_size() - size()) [[unlikely]] {
+      CIEL_THROW_EXCEPTION(std::length_error{"ciel::vector::reserve_spare capacity beyond max_size"});
+    }
+
+    reserve(recommend_cap(size() + count));
+  }
+
+  // Sets size() to count without constructing or destroying anything. Used after elements are written into the
+  // spare capacity at data() + size(), or moved out of the end by other means. count must not exceed capacity(),
+  // the first count elements must be alive, and the ones past them are the caller's responsibility.
+  constexpr void unchecked_set_size(const size_type count) noexcept {
+    assert(count <= capacity());
+
+    end_ = begin_ + count;
+  }
+
   constexpr void shrink_to_fit() {
-    if (size() == capacity()) [[unlikely]] {
+    if (ciel::v::round_up_capacity<allocator_type>(size()) == capacity()) [[unlikely]] {
       return;
     }
 
@@ -930,7 +1212,7 @@ class vector {
 
     const size_type pos_index = pos - begin_;
 
-    if (size() + count > capacity()) {  // expansion
+    if (size() + count > capacity() && !try_grow_in_place(size() + count)) {  // expansion
       split_buffer<value_type, allocator_type&> sb(alloc_, recommend_cap(size() + count), pos_index);
       expansion_callback(sb);
       swap_out_buffer(std::move(sb), pos);
@@ -1208,6 +1490,39 @@ class vector {
     }
   }
 
+  // Takes over data without copying it. data must be deallocatable by alloc with capacity, and its first size
+  // elements must be constructed.
+  [[nodiscard]] static constexpr vector adopt(pointer data, const size_type size, const size_type capacity,
+                                              const allocator_type& alloc = allocator_type()) {
+    assert(size <= capacity);
+    assert(data != nullptr || capacity == 0);
+
+    vector res(alloc);
+
+    if (data) {
+      res.begin_ = data;
+      res.end_ = data + size;
+      res.end_cap_ = data + capacity;
+    }
+
+    return res;
+  }
+
+  [[nodiscard]] static constexpr vector adopt(const raw_parts& parts, const allocator_type& alloc = allocator_type()) {
+    return adopt(parts.data, parts.size, parts.capacity, alloc);
+  }
+
+  // Gives up the buffer and leaves the vector empty. The elements are not destroyed, the caller is responsible
+  // for them and for deallocating the buffer with get_allocator().
+  [[nodiscard]] constexpr raw_parts into_raw_parts() noexcept {
+    const raw_parts res{begin_, size(), capacity()};
+    set_nullptr();
+    return res;
+  }
+
+  // Same as into_raw_parts, for callers that keep track of size and capacity.
+  [[nodiscard]] constexpr pointer release() noexcept { return into_raw_parts().data; }
+
   constexpr void swap(vector& other) noexcept {
     using std::swap;
 
@@ -1222,7 +1537,21 @@ class vector {
   }
 
   constexpr void append(const size_type count) {
-    if (const auto new_size = size() + count; new_size > capacity()) {
+    if (const auto new_size = size() + count; new_size > capacity() && !try_grow_in_place(new_size)) {
+      if constexpr (value_init_via_zeroed) {
+        // A zeroed buffer clears the whole new capacity, about 2 * size() elements below calloc's mmap
+        // threshold, so it only pays off when the appended elements are at least as many as the existing ones,
+        // not on small steps like resize(size() + 1).
+        if (!std::is_constant_evaluated() && count >= size()) {
+          using zeroed_t = split_buffer<value_type, allocator_type&>::zeroed_t;
+
+          split_buffer<value_type, allocator_type&> sb(alloc_, recommend_cap(new_size), size(), zeroed_t{});
+          sb.end_ += count;
+          swap_out_buffer(std::move(sb));
+          return;
+        }
+      }
+
       split_buffer<value_type, allocator_type&> sb(alloc_, recommend_cap(new_size), size());
       sb.construct_at_end(count);
       swap_out_buffer(std::move(sb));
@@ -1233,7 +1562,7 @@ class vector {
   }
 
   constexpr void append(const size_type count, lvalue value) {
-    if (const auto new_size = size() + count; new_size > capacity()) {
+    if (const auto new_size = size() + count; new_size > capacity() && !try_grow_in_place(new_size)) {
       split_buffer<value_type, allocator_type&> sb(alloc_, recommend_cap(new_size), size());
       sb.construct_at_end(count, value);
       swap_out_buffer(std::move(sb));
@@ -1293,6 +1622,17 @@ vector(Iter, Iter, Alloc = Alloc()) -> vector<typename std::iterator_traits<Iter
 template <class T>
 vector(size_t, const T&) -> vector<T>;
 
+#ifdef __cpp_lib_memory_resource
+
+namespace pmr {
+
+template <class T>
+using vector = ciel::v::vector<T, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
+
+#endif
+
 }  // namespace v
 }  // namespace ciel
 
@@ -0,0 +1,91 @@
+// <ciel/aligned_allocator.hpp>
+
+#include <cassert>
+#include <ciel/aligned_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "count_new.h"
+
+static_assert(ciel::aligned_vector<float>::expand_via_memcpy);
+static_assert(ciel::aligned_vector<float>::move_via_memmove);
+static_assert(ciel::aligned_vector<double, 4096>::move_via_memmove);
+static_assert(ciel::aligned_allocator<float, 32>::capacity_granularity == 8);
+static_assert(ciel::aligned_allocator<double, 64>::capacity_granularity == 8);
+static_assert(ciel::aligned_allocator<char, 4096>::capacity_granularity == 64);
+static_assert(ciel::allocator_capacity_granularity<std::allocator<float>>::value == 1);
+
+struct odd {
+  char c[3];
+};
+
+static_assert(ciel::aligned_allocator<odd, 32>::capacity_granularity == 1);
+
+template <class V>
+bool is_aligned(const V& v) {
+  using A = typename V::allocator_type;
+  return reinterpret_cast<std::uintptr_t>(v.data()) % A::alignment == 0 &&
+         v.capacity() % A::capacity_granularity == 0;
+}
+
+template <class T, std::size_t Alignment>
+void test() {
+  using V = ciel::aligned_vector<T, Alignment>;
+
+  V v;
+  for (int i = 0; i < 1000; ++i) {
+    v.emplace_back(static_cast<T>(i));
+    assert(is_aligned(v));
+  }
+
+  v.insert(v.begin() + 3, 100, T(7));
+  assert(is_aligned(v));
+  assert(v.size() == 1100);
+  assert(v[3] == T(7));
+  assert(v[102] == T(7));
+  assert(v[103] == T(3));
+
+  v.resize(13);
+  v.shrink_to_fit();
+  assert(is_aligned(v));
+  assert(v.capacity() >= 13);
+  assert(v.capacity() < 13 + V::allocator_type::capacity_granularity);
+
+  const std::size_t cap = v.capacity();
+  v.shrink_to_fit();
+  assert(v.capacity() == cap);
+
+  V copy(v);
+  assert(is_aligned(copy));
+  assert(copy == v);
+
+  V reserved(ciel::reserve_capacity, 1);
+  assert(is_aligned(reserved));
+  assert(reserved.capacity() == V::allocator_type::capacity_granularity);
+
+  V moved(std::move(copy));
+  assert(is_aligned(moved));
+  assert(moved == v);
+}
+
+int main(int, char**) {
+  test<float, 32>();
+  test<float, 64>();
+  test<double, 64>();
+  test<std::uint8_t, 4096>();
+  test<std::int64_t, 4096>();
+
+  {
+    ciel::aligned_vector<std::string, 64> v{"a", "b", "c"};
+    v.insert(v.begin(), std::string(100, 'x'));
+    assert(reinterpret_cast<std::uintptr_t>(v.data()) % 64 == 0);
+    assert(v[1] == "a");
+    assert(v.back() == "c");
+  }
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
@@ -0,0 +1,278 @@
+// <ciel/any_vector.hpp>
+
+#include <cassert>
+#include <ciel/any_vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "count_new.h"
+
+namespace {
+
+int batch_calls = 0;
+
+template <class T>
+ciel::element_ops counting_ops() {
+  ciel::element_ops ops = ciel::make_element_ops<T>();
+  static auto copy = ops.copy_construct;
+
+  ops.copy_construct = [](void* dst, const void* src, std::size_t n) {
+    ++batch_calls;
+    copy(dst, src, n);
+  };
+
+  return ops;
+}
+
+struct alignas(32) wide {
+  std::uint64_t v[4];
+};
+
+struct no_default {
+  explicit no_default(int i) : v(i) {}
+
+  int v;
+};
+
+using member_ptr = int no_default::*;
+
+}  // namespace
+
+template <class T>
+struct ciel::is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+static_assert(ciel::element_ops_for<int>.trivially_copyable);
+static_assert(ciel::element_ops_for<int>.relocate == nullptr);
+static_assert(ciel::element_ops_for<std::unique_ptr<int>>.relocate == nullptr);
+static_assert(ciel::element_ops_for<std::unique_ptr<int>>.copy_construct == nullptr);
+static_assert(ciel::element_ops_for<int>.zero_initializable);
+static_assert(ciel::element_ops_for<int>.default_construct == nullptr);
+static_assert(!ciel::element_ops_for<member_ptr>.zero_initializable);
+static_assert(ciel::element_ops_for<member_ptr>.default_construct != nullptr);
+static_assert(!ciel::element_ops_for<no_default>.default_constructible);
+static_assert(ciel::element_ops_for<no_default>.default_construct == nullptr);
+
+void test_int() {
+  assert(ciel::element_ops_for<std::string>.relocate != nullptr);
+
+  ciel::any_vector<> v(ciel::element_ops_for<int>);
+
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(&i);
+  }
+  assert(v.size() == 1000);
+  assert(v.get<int>(999) == 999);
+  assert(reinterpret_cast<std::uintptr_t>(v.data()) % 64 == 0);
+
+  v.erase(10, 20);
+  assert(v.size() == 990);
+  assert(v.get<int>(10) == 20);
+
+  v.append_default(5);
+  assert(v.size() == 995);
+  assert(v.get<int>(994) == 0);
+
+  v.resize(3);
+  assert(v.size() == 3);
+  assert(v.get<int>(2) == 2);
+
+  ciel::any_vector<> copy(v);
+  assert(copy.size() == 3);
+  assert(copy.get<int>(1) == 1);
+}
+
+void test_string() {
+  static const ciel::element_ops ops = counting_ops<std::string>();
+  ciel::any_vector<> v(ops);
+
+  std::string batch[100];
+  for (int i = 0; i < 100; ++i) {
+    batch[i] = std::to_string(i) + std::string(30, 's');
+  }
+
+  batch_calls = 0;
+  for (int round = 0; round < 10; ++round) {
+    v.append_copy(batch, 100);
+  }
+  assert(batch_calls == 10);  // one call per batch
+  assert(v.size() == 1000);
+
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    assert(v.get<std::string>(i) == batch[i % 100]);
+  }
+
+  // Shifts the tail through ops.relocate.
+  v.erase(0, 150);
+  assert(v.size() == 850);
+  assert(v.get<std::string>(0) == batch[50]);
+  v.erase(v.size() - 1);
+  v.pop_back();
+  assert(v.size() == 848);
+  assert(v.get<std::string>(847) == batch[97]);
+
+  v.append_default(2);
+  assert(v.get<std::string>(849).empty());
+
+  std::string moved[2] = {"a", std::string(40, 'b')};
+  v.append_relocate(moved, 2);
+  // The relocated-from objects are gone, recreate them for the array's destructor.
+  ::new (&moved[0]) std::string();
+  ::new (&moved[1]) std::string();
+  assert(v.get<std::string>(851) == std::string(40, 'b'));
+
+  ciel::any_vector<> copy(v);
+  assert(copy.size() == v.size());
+  assert(copy.get<std::string>(3) == v.get<std::string>(3));
+
+  ciel::any_vector<> other(std::move(copy));
+  assert(copy.empty());
+  assert(other.size() == v.size());
+}
+
+void test_unique_ptr() {
+  ciel::any_vector<> v(ciel::element_ops_for<std::unique_ptr<int>>);
+
+  v.append_default(10);
+  for (int i = 0; i < 10; ++i) {
+    v.get<std::unique_ptr<int>>(i) = std::make_unique<int>(i);
+  }
+
+  v.reserve(1000);  // grows via memcpy
+  v.erase(2, 4);
+  assert(v.size() == 8);
+  assert(*v.get<std::unique_ptr<int>>(2) == 4);
+}
+
+// Appending elements of the vector itself across a reallocation.
+void test_self_append() {
+  {
+    ciel::any_vector<> v(ciel::element_ops_for<std::string>);
+    const std::string s(40, 'x');
+    v.push_back(&s);
+
+    for (int i = 0; i < 10; ++i) {
+      while (v.size() != v.capacity()) {
+        v.push_back(v[0]);
+      }
+      v.push_back(v[0]);
+    }
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      assert(v.get<std::string>(i) == s);
+    }
+
+    const std::size_t n = v.size();
+    v.append_copy(v.data(), n);
+    assert(v.size() == n * 2);
+    assert(v.get<std::string>(n * 2 - 1) == s);
+  }
+  {
+    ciel::any_vector<> v(ciel::element_ops_for<int>);
+    for (int i = 0; i < 5; ++i) {
+      v.push_back(&i);
+    }
+
+    for (int round = 0; round < 5; ++round) {
+      v.append_copy(v.data(), v.size());
+    }
+    assert(v.size() == 5 * 32);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      assert(v.get<int>(i) == static_cast<int>(i % 5));
+    }
+  }
+}
+
+void test_alignment() {
+  ciel::any_vector<> v(ciel::element_ops_for<wide>);
+  v.append_default(7);
+  assert(reinterpret_cast<std::uintptr_t>(v[3]) % 32 == 0);
+
+#ifdef __cpp_exceptions
+  try {
+    ciel::any_vector<ciel::aligned_allocator<std::byte, 16>> bad(ciel::element_ops_for<wide>);
+    assert(false);
+  } catch (const std::invalid_argument&) {
+  }
+#endif
+}
+
+void test_append_default() {
+  {
+    // A value-initialized member pointer is not zero bytes.
+    ciel::any_vector<> v(ciel::element_ops_for<member_ptr>);
+    v.append_default(3);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      assert(v.get<member_ptr>(i) == nullptr);
+    }
+
+    const member_ptr p = &no_default::v;
+    v.push_back(&p);
+    v.resize(100);
+    assert(v.get<member_ptr>(3) == p);
+    assert(v.get<member_ptr>(99) == nullptr);
+  }
+#ifdef __cpp_exceptions
+  {
+    ciel::any_vector<> v(ciel::element_ops_for<no_default>);
+    const no_default x(1);
+    v.push_back(&x);
+
+    try {
+      v.append_default(1);
+      assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+
+    try {
+      v.resize(2);
+      assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+    assert(v.size() == 1);
+    assert(v.get<no_default>(0).v == 1);
+  }
+  {
+    ciel::any_vector<> v(ciel::element_ops_for<int>);
+    v.append_default(1);
+
+    try {
+      v.append_default(static_cast<std::size_t>(-1) / 2);
+      assert(false);
+    } catch (const std::length_error&) {
+    }
+    assert(v.size() == 1);
+  }
+#endif
+}
+
+// Appending one element at a time reallocates O(log n) times.
+void test_growth() {
+  ciel::any_vector<> v(ciel::element_ops_for<std::string>);
+  const std::string s(40, 'g');
+
+  int reallocations = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const std::size_t capacity = v.capacity();
+    v.push_back(&s);
+    reallocations += v.capacity() != capacity;
+  }
+  assert(reallocations < 20);
+}
+
+int main(int, char**) {
+  test_int();
+  test_string();
+  test_unique_ptr();
+  test_self_append();
+  test_append_default();
+  test_growth();
+  test_alignment();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
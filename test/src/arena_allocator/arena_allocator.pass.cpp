@@ -0,0 +1,103 @@
+// <ciel/arena_allocator.hpp>
+
+#include <cassert>
+#include <ciel/arena_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "count_new.h"
+
+void test_grow_in_place() {
+  ciel::monotonic_arena arena(1 << 20);
+
+  ciel::arena_vector<int> v(arena);
+  v.push_back(0);
+  const int* first = v.data();
+
+  for (int i = 1; i < 10000; ++i) {
+    v.push_back(i);
+  }
+
+  v.insert(v.begin(), 100, -1);
+  v.resize(v.size() + 100);
+
+  // The buffer stays on top of the arena, so it never moved.
+  assert(v.data() == first);
+  assert(v.size() == 10200);
+  assert(v[99] == -1);
+  assert(v[100] == 0);
+  assert(v[10099] == 9999);
+
+  // Another allocation on top stops in-place growth, but not correctness.
+  ciel::arena_vector<int> w(arena);
+  w.push_back(42);
+
+  v.reserve(v.capacity() + 1);
+  assert(v.data() != first);
+  assert(v[10099] == 9999);
+  assert(w[0] == 42);
+}
+
+void test_rollback() {
+  ciel::monotonic_arena arena(1 << 16);
+  arena.deallocate(arena.allocate(8), 8);
+
+  const size_t before = arena.remaining_bytes();
+  {
+    ciel::arena_vector<uint64_t> v(arena);
+    v.reserve(100);
+    assert(arena.remaining_bytes() < before);
+  }
+  // The last allocation is given back.
+  assert(arena.remaining_bytes() == before);
+
+  // A deallocation below the top is not.
+  void* p = arena.allocate(64);
+  void* q = arena.allocate(64);
+  arena.deallocate(p, 64);
+  assert(arena.remaining_bytes() < before - 64);
+  arena.deallocate(q, 64);
+  arena.reset();
+  assert(arena.remaining_bytes() == before);
+}
+
+void test_blocks() {
+  alignas(std::max_align_t) std::byte buffer[256];
+  ciel::monotonic_arena arena(buffer, sizeof(buffer));
+
+  {
+    ciel::arena_vector<std::string> v(arena);
+
+    for (int i = 0; i < 1000; ++i) {
+      v.emplace_back(100, static_cast<char>('a' + i % 26));
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+      assert(v[i].size() == 100);
+      assert(v[i][0] == static_cast<char>('a' + i % 26));
+    }
+
+    ciel::arena_vector<std::string> copy(v);
+    assert(copy == v);
+    assert(copy.get_allocator() == v.get_allocator());
+  }
+
+  arena.reset();
+
+  // Over-aligned requests are honoured in new blocks too.
+  for (int i = 0; i < 100; ++i) {
+    void* p = arena.allocate(1000, 256);
+    assert(reinterpret_cast<uintptr_t>(p) % 256 == 0);
+  }
+
+  arena.reset();
+}
+
+int main() {
+  test_grow_in_place();
+  test_rollback();
+  test_blocks();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
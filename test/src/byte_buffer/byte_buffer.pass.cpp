@@ -0,0 +1,154 @@
+// <ciel/byte_buffer.hpp>
+
+#include <cassert>
+#include <ciel/byte_buffer.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "count_new.h"
+
+namespace {
+
+std::span<const std::byte> bytes_of(std::string_view s) { return std::as_bytes(std::span(s.data(), s.size())); }
+
+std::string_view as_string(std::span<const std::byte> s) {
+  return std::string_view(reinterpret_cast<const char*>(s.data()), s.size());
+}
+
+}  // namespace
+
+void test_basic() {
+  ciel::byte_buffer<> b;
+  assert(b.empty());
+  assert(b.capacity() == 0);
+
+  b.append(bytes_of("hello "));
+  b.append("world", 5);
+  assert(as_string(b.readable()) == "hello world");
+  assert(b[4] == std::byte{'o'});
+
+  b.consume(6);
+  assert(as_string(b.readable()) == "world");
+  assert(b.front_spare() == 6);
+
+  // Consuming everything resets to the front.
+  b.consume(5);
+  assert(b.empty());
+  assert(b.front_spare() == 0);
+
+  std::span<std::byte> w = b.prepare(3);
+  assert(w.size() >= 3);
+  std::memcpy(w.data(), "abc", 3);
+  b.commit(2);
+  assert(as_string(b.readable()) == "ab");
+
+  const ciel::byte_buffer<> copy(b);
+  assert(copy == b);
+
+  ciel::byte_buffer<> moved(std::move(b));
+  assert(moved == copy);
+  assert(b.capacity() == 0);
+
+  moved.shrink_to_fit();
+  assert(moved.capacity() == 2);
+  assert(as_string(moved.readable()) == "ab");
+}
+
+void test_compaction() {
+  ciel::byte_buffer<> b(ciel::reserve_capacity, 100);
+  assert(b.capacity() == 100);
+
+  for (int i = 0; i < 9; ++i) {
+    b.append(bytes_of("0123456789"));
+  }
+  assert(b.size() == 90);
+
+  // front spare (10) < readable (80): grows instead of moving 80 bytes.
+  b.consume(10);
+  const std::byte* old = b.data();
+  (void)b.prepare(15);
+  assert(b.capacity() == 200);
+  assert(b.front_spare() == 0);
+  assert(b.data() != old);
+  assert(b.size() == 80);
+
+  // front spare (150) >= readable (50): compacts in place.
+  const std::string xs(120, 'x');
+  b.append(bytes_of(xs));
+  b.consume(150);
+  assert(b.size() == 50);
+  (void)b.prepare(b.back_spare() + 1);
+  assert(b.capacity() == 200);
+  assert(b.front_spare() == 0);
+  assert(b.size() == 50);
+  assert(as_string(b.readable()) == std::string(50, 'x'));
+}
+
+// Appending the buffer's own readable bytes, across a reallocation and a compaction.
+void test_self_append() {
+  ciel::byte_buffer<> b;
+  b.append(bytes_of("abcd"));
+  b.shrink_to_fit();
+
+  b.append(b.readable());
+  assert(as_string(b.readable()) == "abcdabcd");
+
+  ciel::byte_buffer<> c(ciel::reserve_capacity, 100);
+  const std::string xs(90, 'x');
+  c.append(bytes_of(xs));
+  c.append(bytes_of("0123456789"));
+  c.consume(90);
+  assert(c.back_spare() == 0);
+
+  c.append(c.readable().first(6));
+  assert(c.capacity() == 100);
+  assert(as_string(c.readable()) == "0123456789012345");
+}
+
+void test_random() {
+  std::mt19937 gen(3);
+  ciel::byte_buffer<> b;
+  std::deque<std::uint8_t> model;
+  std::uint8_t next = 0;
+
+  for (int i = 0; i < 10000; ++i) {
+    if (gen() % 2 == 0) {
+      const std::size_t n = gen() % 200;
+      std::span<std::byte> w = b.prepare(n);
+      for (std::size_t j = 0; j < n; ++j) {
+        w[j] = std::byte{next};
+        model.push_back(next++);
+      }
+      b.commit(n);
+
+    } else {
+      const std::size_t n = std::min<std::size_t>(gen() % 300, b.size());
+      b.consume(n);
+      model.erase(model.begin(), model.begin() + n);
+    }
+
+    assert(b.size() == model.size());
+    if (!model.empty()) {
+      assert(b[0] == std::byte{model.front()});
+      assert(b[b.size() - 1] == std::byte{model.back()});
+    }
+  }
+}
+
+int main(int, char**) {
+  test_basic();
+  test_compaction();
+  test_self_append();
+  test_random();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
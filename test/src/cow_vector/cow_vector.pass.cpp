@@ -0,0 +1,244 @@
+// <ciel/cow_vector.hpp>
+
+// cow_vector(const cow_vector& other) noexcept;
+// void push_back(const value_type& value);
+// void set(size_type pos, U&& value);
+// iterator insert(const_iterator pos, const value_type& value);
+// iterator erase(const_iterator first, const_iterator last);
+// void clear() noexcept;
+
+#include <cassert>
+#include <ciel/cow_vector.hpp>
+#include <cstddef>
+#include <string>
+
+#include "../common.h"
+#include "count_new.h"
+#include "min_allocator.h"
+#include "test_macros.h"
+
+template <class C>
+void check_equal(const C& c, const ciel::vector<typename C::value_type>& m) {
+  assert(c.size() == m.size());
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    assert(c[i] == m[i]);
+  }
+}
+
+template <class C>
+void test_sharing(const ciel::vector<typename C::value_type>& input) {
+  C a;
+  assert(a.empty());
+  assert(a.use_count() == 0);
+  assert(a.begin() == a.end());
+
+  for (std::size_t i = 0; i < 10; ++i) {
+    a.push_back(input[i]);
+  }
+  assert(a.size() == 10);
+  assert(a.use_count() == 1);
+
+  // Copies share the buffer.
+  C b = a;
+  C c = b;
+  assert(a.use_count() == 3);
+  assert(a.data() == b.data());
+  assert(a.data() == c.data());
+  assert(a == b);
+
+  // The first modification clones the buffer, others are unaffected.
+  b.push_back(input[10]);
+  assert(a.use_count() == 2);
+  assert(b.use_count() == 1);
+  assert(a.data() != b.data());
+  assert(a.size() == 10);
+  check_equal(b, ciel::vector<typename C::value_type>(input.begin(), input.begin() + 11));
+
+  const auto* p = b.data();
+  b.set(0, input[42]);
+  assert(b.data() == p);  // unique, no clone
+  assert(b.front() == input[42]);
+  assert(a.front() == input[0]);
+
+  c.erase(c.begin() + 2, c.begin() + 5);
+  assert(c.size() == 7);
+  assert(c[2] == input[5]);
+  assert(a[2] == input[2]);
+  assert(a.use_count() == 1);
+
+  C d = a;
+  d.insert(d.begin() + 1, input[99]);
+  assert(d.size() == 11);
+  assert(d[1] == input[99]);
+  assert(d[2] == input[1]);
+  assert(a.size() == 10);
+
+  // Clearing a shared buffer doesn't clone it.
+  C e = a;
+  e.clear();
+  assert(e.empty());
+  assert(e.use_count() == 0);
+  assert(a.size() == 10);
+  assert(a.use_count() == 1);
+
+  // f is unique after its first set, later copies are not affected by writes in place.
+  C f = a;
+  f.set(f.size() - 1, input[100]);
+  assert(f.back() == input[100]);
+  assert(a.back() == input[9]);
+
+  const auto* data = f.data();
+  const C f2 = f;
+  f.set(0, input[200]);
+  assert(f[0] == input[200]);
+  assert(f2[0] == input[0]);
+  assert(f2.data() == data);
+
+  C g = a;
+  g.resize(3);
+  assert(g.size() == 3);
+  assert(a.size() == 10);
+  g.pop_back();
+  assert(g.size() == 2);
+  g.assign(4, input[7]);
+  assert(g.size() == 4);
+  assert(g[3] == input[7]);
+}
+
+// Elements of the vector itself as the new value, while its buffer is unique and while it is shared.
+template <class C>
+void test_self_reference(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  for (const bool shared : {false, true}) {
+    C c(input.begin(), input.begin() + 4);
+    ciel::vector<T> m(input.begin(), input.begin() + 4);
+
+    for (std::size_t i = 0; i < 40; ++i) {
+      C copy;
+      const ciel::vector<T> before = m;
+      if (shared) {
+        copy = c;
+      }
+
+      switch (i % 5) {
+        case 0:
+          c.push_back(c[i % c.size()]);
+          m.push_back(T(m[i % m.size()]));
+          break;
+        case 1:
+          c.set(0, c.back());
+          m[0] = T(m.back());
+          break;
+        case 2:
+          c.insert(c.begin(), c.back());
+          m.insert(m.begin(), T(m.back()));
+          break;
+        case 3:
+          c.emplace_back(c.front());
+          m.emplace_back(T(m.front()));
+          break;
+        default:
+          c.resize(c.size() + 3, c[1]);
+          m.resize(m.size() + 3, T(m[1]));
+          break;
+      }
+
+      check_equal(c, m);
+      if (shared) {
+        check_equal(copy, before);
+      }
+    }
+  }
+}
+
+template <class C>
+void test_construct(const ciel::vector<typename C::value_type>& input) {
+  {
+    ciel::vector<typename C::value_type, typename C::allocator_type> v;
+    v.push_back(input[1]);
+    v.push_back(input[2]);
+    const auto* p = v.data();
+
+    C a(std::move(v));
+    assert(a.data() == p);
+    assert(a.size() == 2);
+
+    C b{input[1], input[2]};
+    assert(a == b);
+    assert(!(a < b));
+  }
+  {
+    const C c(5, input[3]);
+    assert(c.size() == 5);
+    assert(c[4] == input[3]);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    try {
+      (void)c.at(5);
+      assert(false);
+    } catch (const std::out_of_range&) {
+    }
+#endif
+  }
+}
+
+template <class C>
+void test(const ciel::vector<typename C::value_type>& input) {
+  test_sharing<C>(input);
+  test_self_reference<C>(input);
+  test_construct<C>(input);
+}
+
+// A copy throws while a shared buffer is cloned, the vector keeps sharing the old one.
+void test_exceptions() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  using T = throwing_data<int>;
+
+  int throw_after_n = 1000;
+  ciel::cow_vector<T> a;
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(T(i, throw_after_n));
+  }
+  const ciel::cow_vector<T> b = a;
+
+  for (int n = 0; n < 10; ++n) {
+    throw_after_n = n;
+    try {
+      a.push_back(b[0]);
+      assert(false);
+    } catch (int) {
+    }
+
+    assert(a.data() == b.data());
+    assert(a.use_count() == 2);
+  }
+
+  throw_after_n = 5;
+  try {
+    a.set(9, b[0]);
+    assert(false);
+  } catch (int) {
+  }
+  assert(a.data() == b.data());
+
+  throw_after_n = 1000;
+  a.set(9, b[0]);
+  assert(a.use_count() == 1);
+  assert(a[9] == b[0]);
+  assert(b.use_count() == 1);
+  assert(b[9].data_ == 9);
+#endif
+}
+
+int main(int, char**) {
+  {
+    test<ciel::cow_vector<int>>(getIntegerInputs(300));
+    test<ciel::cow_vector<int, min_allocator<int>>>(getIntegerInputs(300));
+    test<ciel::cow_vector<std::string>>(getStringInputsWithLength(300, 40));
+    test_exceptions();
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+// <ciel/fd_io.hpp>
+
+#include <unistd.h>
+
+#include <cassert>
+#include <ciel/fd_io.hpp>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <span>
+
+#include "count_new.h"
+
+namespace {
+
+ciel::vector<std::byte> make_bytes(const size_t n) {
+  ciel::vector<std::byte> res(ciel::reserve_capacity, n);
+  for (size_t i = 0; i < n; ++i) {
+    res.unchecked_emplace_back(static_cast<std::byte>(i * 31 + 7));
+  }
+
+  return res;
+}
+
+}  // namespace
+
+void test_pipe() {
+  int fds[2];
+  assert(pipe(fds) == 0);
+
+  const ciel::vector<std::byte> src = make_bytes(1000);
+  assert(ciel::write_to_fd(fds[1], src) == 1000);
+  assert(close(fds[1]) == 0);
+
+  ciel::vector<std::byte> dst = make_bytes(3);
+  assert(ciel::append_from_fd(dst, fds[0], 16) > 0);
+  assert(dst.capacity() >= 3 + 16);
+
+  assert(ciel::append_all_from_fd(dst, fds[0], 16) >= 0);
+  assert(dst.size() == 1003);
+  assert(std::memcmp(dst.data() + 3, src.data(), 1000) == 0);
+  assert(std::memcmp(dst.data(), make_bytes(3).data(), 3) == 0);
+
+  // EOF.
+  assert(ciel::append_from_fd(dst, fds[0]) == 0);
+  assert(dst.size() == 1003);
+
+  assert(close(fds[0]) == 0);
+}
+
+void test_large_file() {
+  std::FILE* file = std::tmpfile();
+  assert(file != nullptr);
+  const int fd = fileno(file);
+
+  const ciel::vector<std::byte> a = make_bytes(1 << 20);
+  const ciel::vector<std::byte> b;
+  const ciel::vector<std::byte> c = make_bytes(12345);
+  const ciel::vector<std::byte> all[] = {a, b, c};
+
+  assert(ciel::write_to_fd(fd, std::span<const ciel::vector<std::byte>>(all)) == (1 << 20) + 12345);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+
+  ciel::vector<std::byte> dst;
+  assert(ciel::append_all_from_fd(dst, fd) == (1 << 20) + 12345);
+  assert(dst.size() == (1 << 20) + 12345);
+  assert(std::memcmp(dst.data(), a.data(), a.size()) == 0);
+  assert(std::memcmp(dst.data() + a.size(), c.data(), c.size()) == 0);
+
+  std::fclose(file);
+}
+
+void test_write_non_bytes() {
+  int fds[2];
+  assert(pipe(fds) == 0);
+
+  const ciel::vector<int> src{1, 2, 3, 4};
+  assert(ciel::write_to_fd(fds[1], src) == 4 * sizeof(int));
+  assert(close(fds[1]) == 0);
+
+  ciel::vector<unsigned char> dst;
+  assert(ciel::append_all_from_fd(dst, fds[0]) == 4 * sizeof(int));
+  assert(std::memcmp(dst.data(), src.data(), dst.size()) == 0);
+
+  assert(close(fds[0]) == 0);
+}
+
+void test_errors() {
+  ciel::vector<std::byte> v;
+  assert(ciel::append_from_fd(v, -1) == -1);
+  assert(v.empty());
+
+  const ciel::vector<std::byte> src = make_bytes(10);
+  assert(ciel::write_to_fd(-1, src) == -1);
+
+  // Nothing to write is not an error, even on a bad descriptor.
+  assert(ciel::write_to_fd(-1, ciel::vector<std::byte>{}) == 0);
+}
+
+int main(int, char**) {
+  test_pipe();
+  test_large_file();
+  test_write_non_bytes();
+  test_errors();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
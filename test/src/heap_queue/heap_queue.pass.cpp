@@ -0,0 +1,300 @@
+// <ciel/heap_queue.hpp>
+
+// void push(const value_type& value);
+// void emplace(Args&&... args);
+// void push_bulk(Iter first, Iter last);
+// void pop();
+// value_type pop_value();
+// void pop_into(vector<value_type, Alloc>& out);
+
+#include <algorithm>
+#include <cassert>
+#include <ciel/heap_queue.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "../common.h"
+#include "count_new.h"
+#include "test_macros.h"
+
+template <class T>
+struct ciel::is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+struct deref_less {
+  bool operator()(const std::unique_ptr<int>& lhs, const std::unique_ptr<int>& rhs) const { return *lhs < *rhs; }
+};
+
+static_assert(ciel::heap_queue<std::unique_ptr<int>, 2, deref_less>::container_type::move_via_memmove);
+static_assert(!ciel::heap_queue<std::string>::container_type::move_via_memmove);
+
+// Every element of m is in h exactly once, and h is a heap.
+template <class T, std::size_t Arity, class Compare>
+void check_heap(const ciel::heap_queue<T, Arity, Compare>& h, const ciel::vector<T>& m) {
+  assert(h.size() == m.size());
+
+  ciel::vector<T> elements(h.container().begin(), h.container().end());
+  ciel::vector<T> expected = m;
+  std::sort(elements.begin(), elements.end(), h.value_comp());
+  std::sort(expected.begin(), expected.end(), h.value_comp());
+  assert(elements == expected);
+
+  const auto& c = h.container();
+  for (std::size_t i = 1; i < c.size(); ++i) {
+    assert(!h.value_comp()(c[(i - 1) / Arity], c[i]));
+  }
+}
+
+template <class C>
+void test_push_pop(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  std::mt19937 gen(42);
+  const typename C::value_compare comp{};
+  ciel::vector<T> m;
+  C h;
+
+  // Interleaved push and pop.
+  for (std::size_t i = 0; i < 2000; ++i) {
+    const T& value = input[gen() % input.size()];
+    h.push(value);
+    m.push_back(value);
+
+    if (i % 3 == 0) {
+      const auto it = std::max_element(m.begin(), m.end(), comp);
+      assert(h.top() == *it);
+      h.pop();
+      m.erase(it);
+    }
+  }
+  check_heap(h, m);
+
+  ciel::vector<T> sorted = m;
+  std::sort(sorted.begin(), sorted.end(), comp);
+
+  // Drain half by pop_into, the rest by pop_value.
+  ciel::vector<T> out;
+  const std::size_t half = sorted.size() / 2;
+  for (std::size_t i = 0; i < half; ++i) {
+    h.pop_into(out);
+  }
+  for (std::size_t i = 0; i < half; ++i) {
+    assert(out[i] == sorted[sorted.size() - 1 - i]);
+  }
+  for (std::size_t i = half; i < sorted.size(); ++i) {
+    assert(h.pop_value() == sorted[sorted.size() - 1 - i]);
+  }
+  assert(h.empty());
+}
+
+// A large and a small range, to go through both heapify strategies.
+template <class C>
+void test_push_bulk(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  C h(input.begin(), input.begin() + 10);
+  ciel::vector<T> m(input.begin(), input.begin() + 10);
+
+  h.push_bulk(input.rbegin(), input.rend());
+  m.insert(m.end(), input.rbegin(), input.rend());
+  check_heap(h, m);
+
+  h.push_bulk({input[5], input[0]});
+  m.push_back(input[5]);
+  m.push_back(input[0]);
+  check_heap(h, m);
+
+  const C h2{input[3], input[1], input[4]};
+  check_heap(h2, ciel::vector<T>{input[3], input[1], input[4]});
+}
+
+// Elements of the heap itself as the new values, across reallocations of the container.
+template <class C>
+void test_self_reference(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  C h;
+  ciel::vector<T> m;
+  for (std::size_t i = 0; i < 5; ++i) {
+    h.push(input[i]);
+    m.push_back(input[i]);
+  }
+
+  for (std::size_t i = 0; i < 100; ++i) {
+    const T top = h.top();
+    const T last = h.container().back();
+
+    if (i % 2 == 0) {
+      h.push(h.top());
+      m.push_back(top);
+
+    } else {
+      h.emplace(h.container().back());
+      m.push_back(last);
+    }
+    check_heap(h, m);
+  }
+
+  const ciel::vector<T> copy(h.container().begin(), h.container().end());
+  h.push_bulk(h.container().begin(), h.container().end());
+  m.insert(m.end(), copy.begin(), copy.end());
+  check_heap(h, m);
+}
+
+template <class C>
+void test(const ciel::vector<typename C::value_type>& input) {
+  test_push_pop<C>(input);
+  test_push_bulk<C>(input);
+  test_self_reference<C>(input);
+}
+
+// Elements that are relocated with memcpy.
+template <std::size_t Arity>
+void test_relocatable() {
+  using C = ciel::heap_queue<std::unique_ptr<int>, Arity, deref_less>;
+
+  const ciel::vector<int> input = getIntegerInputs(1000);
+  std::mt19937 gen(Arity);
+  C h;
+
+  ciel::vector<std::unique_ptr<int>> bulk;
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    const int x = input[gen() % input.size()];
+    if (i % 2 == 0) {
+      h.push(std::make_unique<int>(x));
+
+    } else {
+      bulk.push_back(std::make_unique<int>(x));
+    }
+  }
+  h.push_bulk(std::make_move_iterator(bulk.begin()), std::make_move_iterator(bulk.end()));
+  assert(h.size() == input.size());
+
+  ciel::vector<std::unique_ptr<int>> out;
+  while (h.size() > input.size() / 2) {
+    h.pop_into(out);
+  }
+  for (std::size_t i = 1; i < out.size(); ++i) {
+    assert(*out[i] <= *out[i - 1]);
+  }
+
+  int last = *out.back();
+  while (!h.empty()) {
+    const std::unique_ptr<int> p = h.pop_value();
+    assert(*p <= last);
+    last = *p;
+  }
+}
+
+// A throwing comparison or copy leaves every element in the heap exactly once.
+template <class T>
+struct throwing_less {
+  int* countdown;
+
+  bool operator()(const T& lhs, const T& rhs) const {
+    if (--*countdown == 0) {
+      throw 0;
+    }
+    return lhs < rhs;
+  }
+};
+
+template <class T>
+void test_throwing_compare(const ciel::vector<T>& input) {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  using C = ciel::heap_queue<T, 2, throwing_less<T>>;
+
+  int countdown = -1;
+  C h(throwing_less<T>{&countdown});
+  ciel::vector<T> m;
+  for (std::size_t i = 0; i < 100; ++i) {
+    h.push(input[i]);
+    m.push_back(input[i]);
+  }
+
+  countdown = 3;
+  try {
+    h.pop();
+    assert(false);
+  } catch (int) {
+  }
+  assert(h.size() == 99);
+
+  // The top is gone, the other elements are still there.
+  countdown = -1;
+  std::sort(m.begin(), m.end());
+  m.pop_back();
+  ciel::vector<T> elements(h.container().begin(), h.container().end());
+  std::sort(elements.begin(), elements.end());
+  assert(elements == m);
+
+  countdown = 2;
+  try {
+    h.push(input[100]);
+    assert(false);
+  } catch (int) {
+  }
+  assert(h.size() == 100);
+
+  countdown = -1;
+  m.push_back(input[100]);
+  std::sort(m.begin(), m.end());
+  elements.assign(h.container().begin(), h.container().end());
+  std::sort(elements.begin(), elements.end());
+  assert(elements == m);
+#endif
+}
+
+void test_throwing_copy() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  using T = throwing_data<int>;
+
+  struct data_less {
+    bool operator()(const T& lhs, const T& rhs) const { return lhs.data_ < rhs.data_; }
+  };
+
+  int throw_after_n = 1000;
+  ciel::heap_queue<T, 4, data_less> h;
+  for (int i = 0; i < 10; ++i) {
+    h.push(T(i, throw_after_n));
+  }
+  while (h.size() < h.capacity()) {
+    h.push(h.top());
+  }
+  const ciel::vector<T> copy = h.container();
+
+  // The copy of the top throws, while it is pushed into a full container.
+  throw_after_n = 0;
+  try {
+    h.push(h.top());
+    assert(false);
+  } catch (int) {
+  }
+  assert(h.container() == copy);
+
+  throw_after_n = 1000;
+  h.push(h.top());
+  assert(h.size() == copy.size() + 1);
+  assert(h.top().data_ == 9);
+#endif
+}
+
+int main(int, char**) {
+  {
+    test<ciel::heap_queue<int, 2>>(getIntegerInputs(300));
+    test<ciel::heap_queue<int, 4>>(getIntegerInputs(300));
+    test<ciel::heap_queue<int, 3, std::greater<int>>>(getIntegerInputs(300));
+    test<ciel::heap_queue<std::string, 2>>(getStringInputsWithLength(300, 20));
+    test<ciel::heap_queue<std::string, 4, std::greater<std::string>>>(getStringInputsWithLength(300, 20));
+    test_relocatable<2>();
+    test_relocatable<4>();
+    test_throwing_compare(getIntegerInputs(200));
+    test_throwing_compare(getStringInputsWithLength(200, 20));
+    test_throwing_copy();
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
@@ -0,0 +1,276 @@
+// <ciel/jagged_vector.hpp>
+
+// void push_row(R&& r);
+// void push_back_to_last_row(const value_type& value);
+// value_type& emplace_back_to_last_row(Args&&... args);
+// void append_to_last_row(R&& r);
+// void pop_row() noexcept;
+// explicit jagged_vector(R&& nested, const allocator_type& alloc = allocator_type());
+
+#include <cassert>
+#include <ciel/jagged_vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../common.h"
+#include "count_new.h"
+#include "min_allocator.h"
+#include "test_macros.h"
+
+static_assert(std::random_access_iterator<ciel::jagged_vector<int>::iterator>);
+static_assert(std::random_access_iterator<ciel::jagged_vector<int>::const_iterator>);
+static_assert(std::ranges::random_access_range<const ciel::jagged_vector<int>>);
+
+template <class C, class Model>
+void check_equal(const C& j, const Model& m) {
+  assert(j.rows() == m.size());
+
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    assert(j.row_size(i) == m[i].size());
+    assert(std::ranges::equal(j[i], m[i]));
+    n += m[i].size();
+  }
+  assert(j.values_size() == n);
+}
+
+template <class C>
+void test_push_row(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  C j;
+  assert(j.empty());
+  assert(j.rows() == 0);
+  assert(j.begin() == j.end());
+
+  j.push_row(std::vector<T>{input[1], input[2], input[3]});
+  j.push_row();
+  j.push_row(std::list<T>{input[4]});
+  j.push_row(std::views::iota(5, 8) | std::views::transform([&](int i) { return input[i]; }));
+  assert(j.rows() == 4);
+  assert(j.values_size() == 7);
+
+  assert(j.row_size(0) == 3);
+  assert(j.row_size(1) == 0);
+  assert(j.row(1).empty());
+  assert(j[2].size() == 1);
+  assert(j[2][0] == input[4]);
+  assert(j[3][2] == input[7]);
+
+  j.push_back_to_last_row(input[8]);
+  j.emplace_back_to_last_row(input[9]);
+  j.append_to_last_row(std::vector<T>{input[10], input[11]});
+  assert(j.back().size() == 7);
+  assert(j.back().back() == input[11]);
+
+  j[0][1] = input[42];
+  assert(j.values()[1] == input[42]);
+
+  std::size_t n = 0;
+  for (auto r : j) {
+    n += r.size();
+  }
+  assert(n == j.values_size());
+  assert(j.end() - j.begin() == 4);
+
+  j.pop_row();
+  assert(j.rows() == 3);
+  assert(j.values_size() == 4);
+  j.pop_row();
+  j.pop_row();
+  j.pop_row();
+  assert(j.empty());
+  assert(j.values_size() == 0);
+
+  j.push_row({input[1]});
+  assert(j.rows() == 1);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    (void)j.row(1);
+    assert(false);
+  } catch (const std::out_of_range&) {
+  }
+#endif
+}
+
+// Rows and elements of the jagged_vector itself as the new values, across reallocations of values.
+template <class C>
+void test_self_reference(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  C j;
+  std::vector<std::vector<T>> m;
+  j.push_row(std::vector<T>(input.begin(), input.begin() + 5));
+  m.emplace_back(input.begin(), input.begin() + 5);
+
+  for (std::size_t i = 0; i < 60; ++i) {
+    switch (i % 5) {
+      case 0:
+        j.push_row(j[0]);
+        m.push_back(m[0]);
+        break;
+      case 1: {
+        j.append_to_last_row(j.back());
+        const std::vector<T> row = m.back();
+        m.back().insert(m.back().end(), row.begin(), row.end());
+        break;
+      }
+      case 2:
+        j.push_back_to_last_row(j[0][i % 5]);
+        m.back().push_back(m[0][i % 5]);
+        break;
+      case 3:
+        j.emplace_back_to_last_row(j[i / 5][0]);
+        m.back().push_back(m[i / 5][0]);
+        break;
+      default: {
+        const auto row = j[i / 5];
+        j.push_row(std::ranges::subrange(std::counted_iterator(row.begin(), 3), std::default_sentinel));
+        m.emplace_back(m[i / 5].begin(), m[i / 5].begin() + 3);
+        break;
+      }
+    }
+
+    check_equal(j, m);
+  }
+
+  // A sized forward range whose sentinel is not an iterator, from a vector with no spare room.
+  C k;
+  k.push_row(std::span(input.data(), 3));
+  for (std::size_t i = 0; i < 20; ++i) {
+    const auto row = k[i];
+    k.push_row(std::ranges::subrange(std::counted_iterator(row.begin(), 3), std::default_sentinel));
+  }
+  for (std::size_t i = 0; i < k.rows(); ++i) {
+    assert(std::ranges::equal(k[i], std::span(input.data(), 3)));
+  }
+}
+
+// Conversion from nested vectors.
+template <class C>
+void test_nested(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  std::vector<std::vector<T>> nested;
+  for (std::size_t i = 0; i < 100; ++i) {
+    nested.emplace_back(input.begin() + i, input.begin() + i + i % 7);
+  }
+
+  const C j(nested);
+  check_equal(j, nested);
+
+  C copy = j;
+  assert(copy == j);
+  copy.push_row();
+  assert(!(copy == j));
+
+  const C k{{input[1], input[2]}, {}, {input[3]}};
+  assert(k.rows() == 3);
+  assert(k.row_size(1) == 0);
+  assert(k[2][0] == input[3]);
+}
+
+template <class C>
+void test(const ciel::vector<typename C::value_type>& input) {
+  test_push_row<C>(input);
+  test_self_reference<C>(input);
+  test_nested<C>(input);
+}
+
+// A copy throws partway through a row, the jagged_vector is left as it was.
+void test_exceptions() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  using T = throwing_data<int>;
+  using C = ciel::jagged_vector<T>;
+
+  int throw_after_n = 1000;
+  C j;
+  for (int r = 0; r < 4; ++r) {
+    ciel::vector<T> row;
+    for (int c = 0; c < 5; ++c) {
+      row.emplace_back(r * 5 + c, throw_after_n);
+    }
+    j.push_row(row);
+  }
+  const C copy(j);
+
+  for (int n = 0; n < 5; ++n) {
+    throw_after_n = n;
+    try {
+      j.push_row(j[1]);
+      assert(false);
+    } catch (int) {
+    }
+    assert(j == copy);
+
+    throw_after_n = n;
+    try {
+      j.append_to_last_row(j[0]);
+      assert(false);
+    } catch (int) {
+    }
+    assert(j == copy);
+  }
+
+  throw_after_n = 0;
+  try {
+    j.push_back_to_last_row(j[0][0]);
+    assert(false);
+  } catch (int) {
+  }
+  assert(j == copy);
+
+  throw_after_n = 1000;
+  const std::vector<std::vector<T>> nested(3, std::vector<T>(copy[0].begin(), copy[0].end()));
+  throw_after_n = 7;
+  try {
+    const C k(nested);
+    assert(false);
+  } catch (int) {
+  }
+
+  throw_after_n = 1000;
+  j.push_row(j[1]);
+  assert(j.rows() == 5);
+  assert(j[4][0].data_ == 5);
+#endif
+}
+
+int main(int, char**) {
+  {
+    test<ciel::jagged_vector<int>>(getIntegerInputs(200));
+    test<ciel::jagged_vector<int, std::uint32_t, min_allocator<int>>>(getIntegerInputs(200));
+    test<ciel::jagged_vector<std::string, std::uint16_t>>(getStringInputsWithLength(200, 30));
+    test_exceptions();
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+  {
+    std::vector<std::vector<int>> nested{{1, 2}, {}, {3, 4, 5}};
+
+    globalMemCounter.reset();
+    const ciel::jagged_vector<int> j(nested);
+    assert(globalMemCounter.checkNewCalledEq(2));  // offsets and values
+  }
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  {
+    // Offsets that would overflow offset_type are rejected.
+    ciel::jagged_vector<char, std::uint8_t> j;
+    j.push_row(std::string(255, 'a'));
+    try {
+      j.push_back_to_last_row('b');
+      assert(false);
+    } catch (const std::length_error&) {
+    }
+    assert(j.values_size() == 255);
+  }
+#endif
+
+  return 0;
+}
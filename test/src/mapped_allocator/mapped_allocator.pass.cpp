@@ -0,0 +1,165 @@
+// <ciel/mapped_allocator.hpp>
+
+#include <unistd.h>
+
+#include <cassert>
+#include <ciel/mapped_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#include "count_new.h"
+
+namespace {
+
+struct point {
+  int32_t x;
+  int32_t y;
+};
+
+// Leaves an unused path in path.
+void make_path(char* path) {
+  const int fd = mkstemp(path);
+  assert(fd != -1);
+  close(fd);
+  unlink(path);
+}
+
+}  // namespace
+
+void test_grow_in_place(const char* path) {
+  ciel::mapped_file file(path, size_t{1} << 30);
+  assert(file.capacity_bytes() == 0);
+
+  ciel::mapped_vector<uint64_t> v = ciel::load_mapped_vector<uint64_t>(file);
+  assert(v.empty());
+
+  v.push_back(0);
+  const uint64_t* first = v.data();
+
+  for (uint64_t i = 1; i < 1000000; ++i) {
+    v.push_back(i * 3);
+  }
+
+  v.insert(v.begin() + 1, 10, 7);
+  v.erase(v.begin() + 1, v.begin() + 11);
+  v.resize(v.size() + 1000);
+  v.reserve(v.capacity() + 1);
+
+  // Never moved, never copied.
+  assert(v.data() == first);
+  assert(file.capacity_bytes() == v.capacity() * sizeof(uint64_t));
+
+  v.resize(1000000);
+  for (uint64_t i = 0; i < 1000000; ++i) {
+    assert(v[i] == i * 3);
+  }
+
+  ciel::sync_mapped_vector(v);
+}
+
+void test_reload(const char* path) {
+  ciel::mapped_file file(path, size_t{1} << 30);
+
+  {
+    ciel::mapped_vector<uint64_t> v = ciel::load_mapped_vector<uint64_t>(file);
+    assert(v.size() == 1000000);
+    assert(v.capacity() * sizeof(uint64_t) == file.capacity_bytes());
+
+    for (uint64_t i = 0; i < 1000000; ++i) {
+      assert(v[i] == i * 3);
+    }
+
+    // Only one buffer per file.
+#ifdef __cpp_exceptions
+    try {
+      ciel::mapped_vector<uint64_t> other(v);
+      assert(false);
+    } catch (const std::bad_alloc&) {
+    }
+#endif
+
+    v.resize(10);
+    v.emplace_back(42);
+    ciel::sync_mapped_vector(v);
+  }
+
+#ifdef __cpp_exceptions
+  try {
+    static_cast<void>(ciel::load_mapped_vector<uint32_t>(file));
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+#endif
+
+  ciel::mapped_vector<uint64_t> v = ciel::load_mapped_vector<uint64_t>(file);
+  assert(v.size() == 11);
+  assert(v[9] == 27);
+  assert(v[10] == 42);
+
+  // Replacing the contents reuses the buffer.
+  const uint64_t* first = v.data();
+  v.assign({1, 2, 3});
+  assert(v.data() == first);
+}
+
+void test_move(const char* path) {
+  ciel::mapped_file file(path, size_t{1} << 20);
+
+  ciel::mapped_vector<point> v{ciel::mapped_allocator<point>(file)};
+  v.push_back({1, 2});
+  v.push_back({3, 4});
+
+  ciel::mapped_vector<point> v2(std::move(v));
+  assert(v.empty());
+  assert(v2.size() == 2);
+  assert(v2[1].x == 3 && v2[1].y == 4);
+
+  // Beyond max_bytes.
+#ifdef __cpp_exceptions
+  try {
+    v2.reserve(v2.max_size() + 1);
+    assert(false);
+  } catch (const std::length_error&) {
+  }
+#endif
+
+  ciel::sync_mapped_vector(v2);
+}
+
+void test_bad_file() {
+  char path[] = "/tmp/ciel_mapped_XXXXXX";
+  const int fd = mkstemp(path);
+  assert(fd != -1);
+  assert(write(fd, "not a mapped vector", 19) == 19);
+  close(fd);
+
+#ifdef __cpp_exceptions
+  try {
+    ciel::mapped_file file(path);
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+#endif
+
+  unlink(path);
+}
+
+int main(int, char**) {
+  char path[] = "/tmp/ciel_mapped_XXXXXX";
+  make_path(path);
+
+  test_grow_in_place(path);
+  test_reload(path);
+  unlink(path);
+
+  test_move(path);
+  unlink(path);
+
+  test_bad_file();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
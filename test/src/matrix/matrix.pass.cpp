@@ -0,0 +1,335 @@
+// <ciel/matrix.hpp>
+
+// row_type push_row(R&& r);
+// row_type emplace_row();
+// void insert_column(size_type pos, const value_type& value);
+// void insert_column(size_type pos, R&& values);
+// void erase_column(size_type pos);
+// void erase_row(size_type r);
+
+#include <cassert>
+#include <ciel/aligned_allocator.hpp>
+#include <ciel/matrix.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "../common.h"
+#include "count_new.h"
+#include "test_macros.h"
+
+// The first rows of m hold input in order, as long as no column has been inserted or erased.
+template <class C>
+void check_rows(const C& m, const ciel::vector<typename C::value_type>& input, std::size_t rows) {
+  assert(m.rows() >= rows);
+
+  for (std::size_t r = 0; r < rows; ++r) {
+    assert(m.row(r).size() == m.cols());
+    for (std::size_t c = 0; c < m.cols(); ++c) {
+      assert(m(r, c) == input[r * m.cols() + c]);
+    }
+  }
+}
+
+template <class C>
+C make_matrix(const ciel::vector<typename C::value_type>& input, std::size_t rows, std::size_t cols, bool padded) {
+  C m = padded ? C(ciel::pad_rows, 0, cols) : C();
+
+  for (std::size_t r = 0; r < rows; ++r) {
+    m.push_row(std::span(input.data() + r * cols, cols));
+  }
+
+  return m;
+}
+
+template <class C>
+void test_push_row(const ciel::vector<typename C::value_type>& input, bool padded) {
+  using T = typename C::value_type;
+
+  {
+    C m = make_matrix<C>(input, 20, 5, padded);
+    assert(m.rows() == 20);
+    check_rows(m, input, 20);
+    assert(m.stride() >= m.cols());
+  }
+  {
+    // The first row defines cols().
+    C m;
+    m.push_row(ciel::vector<T>(input.begin(), input.begin() + 3));
+    assert(m.cols() == 3);
+    assert(m.stride() == 3);
+    assert(m.rows() == 1);
+  }
+  {
+    // A row of the matrix itself, while the buffer is full.
+    C m = make_matrix<C>(input, 1, 5, padded);
+    while (m.container().size() + m.stride() <= m.container().capacity()) {
+      m.push_row(m.row(0));
+    }
+
+    const T* data = m.data();
+    m.push_row(m.row(0));
+    assert(m.data() != data);
+    for (std::size_t r = 0; r < m.rows(); ++r) {
+      for (std::size_t c = 0; c < m.cols(); ++c) {
+        assert(m(r, c) == input[c]);
+      }
+    }
+  }
+  {
+    C m = make_matrix<C>(input, 3, 4, padded);
+    m.emplace_row()[2] = input[0];
+    assert(m.rows() == 4);
+    assert(m(3, 0) == T());
+    assert(m(3, 2) == input[0]);
+    check_rows(m, input, 3);
+  }
+}
+
+template <class C>
+void test_insert_column(const ciel::vector<typename C::value_type>& input, bool padded) {
+  using T = typename C::value_type;
+
+  {
+    C m = make_matrix<C>(input, 10, 4, padded);
+    const T value = input[100];
+
+    m.insert_column(0, value);
+    m.insert_column(3, value);
+    m.insert_column(m.cols(), value);
+    assert(m.cols() == 7);
+
+    for (std::size_t r = 0; r < m.rows(); ++r) {
+      const auto row = m.row(r);
+      assert(row[0] == value);
+      assert(row[1] == input[r * 4]);
+      assert(row[2] == input[r * 4 + 1]);
+      assert(row[3] == value);
+      assert(row[4] == input[r * 4 + 2]);
+      assert(row[5] == input[r * 4 + 3]);
+      assert(row[6] == value);
+    }
+  }
+  {
+    // An element of the matrix itself, in a column that gets shifted.
+    C m = make_matrix<C>(input, 10, 4, padded);
+    const T value = m(3, 2);
+
+    m.insert_column(1, m(3, 2));
+    for (std::size_t r = 0; r < m.rows(); ++r) {
+      assert(m(r, 1) == value);
+      assert(m(r, 3) == input[r * 4 + 2]);
+    }
+  }
+  {
+    ciel::vector<T> column(input.begin() + 100, input.begin() + 110);
+    C m = make_matrix<C>(input, 10, 4, padded);
+
+    m.insert_column(2, column);
+    for (std::size_t r = 0; r < m.rows(); ++r) {
+      assert(m(r, 1) == input[r * 4 + 1]);
+      assert(m(r, 2) == column[r]);
+      assert(m(r, 3) == input[r * 4 + 2]);
+    }
+  }
+  {
+    // A row of the matrix itself, for the in-place path and for the reallocating one.
+    for (std::size_t cols = 4; cols < 8; ++cols) {
+      C m = make_matrix<C>(input, cols, cols, padded);
+      const ciel::vector<T> row(m.row(2).begin(), m.row(2).end());
+
+      m.insert_column(0, m.row(2));
+      for (std::size_t r = 0; r < m.rows(); ++r) {
+        assert(m(r, 0) == row[r]);
+        for (std::size_t c = 0; c < cols; ++c) {
+          assert(m(r, c + 1) == input[r * cols + c]);
+        }
+      }
+    }
+  }
+  {
+    // A column of the matrix itself.
+    C m = make_matrix<C>(input, 10, 4, padded);
+    auto column = std::views::iota(std::size_t{0}, m.rows()) |
+                  std::views::transform([&](std::size_t r) -> const T& { return std::as_const(m)(r, 3); });
+
+    m.insert_column(0, column);
+    for (std::size_t r = 0; r < m.rows(); ++r) {
+      assert(m(r, 0) == input[r * 4 + 3]);
+      assert(m(r, 4) == input[r * 4 + 3]);
+    }
+  }
+  {
+    C m;
+    m.insert_column(0, input[0]);
+    m.insert_column(0, input[0]);
+    assert(m.cols() == 2);
+    assert(m.rows() == 0);
+    assert(m.empty());
+  }
+}
+
+template <class C>
+void test_erase(const ciel::vector<typename C::value_type>& input, bool padded) {
+  C m = make_matrix<C>(input, 10, 5, padded);
+
+  m.erase_column(0);
+  m.erase_column(2);
+  m.erase_column(m.cols() - 1);
+  assert(m.cols() == 2);
+  for (std::size_t r = 0; r < m.rows(); ++r) {
+    assert(m(r, 0) == input[r * 5 + 1]);
+    assert(m(r, 1) == input[r * 5 + 2]);
+  }
+
+  m.erase_row(7);
+  m.pop_row();
+  assert(m.rows() == 8);
+  assert(m(6, 0) == input[6 * 5 + 1]);
+  assert(m(7, 0) == input[8 * 5 + 1]);
+
+  const C copy(m);
+  assert(copy == m);
+
+  C moved(std::move(m));
+  assert(moved == copy);
+  assert(m.rows() == 0);
+
+  moved.clear();
+  assert(moved.rows() == 0);
+  assert(moved.cols() == 2);
+}
+
+template <class C>
+void test(const ciel::vector<typename C::value_type>& input) {
+  for (const bool padded : {false, true}) {
+    test_push_row<C>(input, padded);
+    test_insert_column<C>(input, padded);
+    test_erase<C>(input, padded);
+  }
+}
+
+void test_padding() {
+  ciel::matrix<float, ciel::aligned_allocator<float, 64>> m(ciel::pad_rows, 3, 5, 1.0f);
+  assert(m.stride() == 16);
+  assert(m.padded());
+  for (std::size_t r = 0; r < m.rows(); ++r) {
+    assert(reinterpret_cast<std::uintptr_t>(m.row(r).data()) % 64 == 0);
+  }
+
+  // Fits in the padding, no reallocation.
+  const float* data = m.data();
+  m.insert_column(2, 2.0f);
+  assert(m.data() == data);
+  assert(m.cols() == 6);
+  assert(m(1, 2) == 2.0f);
+  assert(m(1, 5) == 1.0f);
+}
+
+void test_initializer_list() {
+  ciel::matrix<int> m{
+      {1, 2, 3},
+      {4, 5, 6}
+  };
+  assert(m.rows() == 2);
+  assert(m.cols() == 3);
+  assert(m.stride() == 3);
+  assert(m[1][0] == 4);
+
+  const ciel::matrix<int> n(2, 3, 7);
+  assert(n(1, 2) == 7);
+  assert(n != m);
+}
+
+void test_exceptions() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  {
+    using T = throwing_data<int>;
+    int throw_after_n = 1000;
+
+    ciel::matrix<T> m;
+    for (int r = 0; r < 4; ++r) {
+      ciel::vector<T> row;
+      for (int c = 0; c < 3; ++c) {
+        row.emplace_back(r * 3 + c, throw_after_n);
+      }
+      m.push_row(row);
+    }
+    const ciel::matrix<T> copy(m);
+
+    // Throws while copying the old elements into the new buffer.
+    throw_after_n = 6;
+    try {
+      m.insert_column(1, m(0, 0));
+      assert(false);
+    } catch (int) {
+    }
+    assert(m == copy);
+
+    // Throws while copying a row of the matrix itself into the new buffer.
+    throw_after_n = 1000;
+    while (m.container().size() + m.stride() <= m.container().capacity()) {
+      m.push_row(copy.row(0));
+    }
+    const ciel::matrix<T> full(m);
+
+    throw_after_n = 2;
+    try {
+      m.push_row(m.row(1));
+      assert(false);
+    } catch (int) {
+    }
+    assert(m == full);
+
+    throw_after_n = 1000;
+    try {
+      m.push_row(ciel::vector<T>(m.cols() + 1, copy(0, 0)));
+      assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+    assert(m == full);
+
+    try {
+      (void)m.at(m.rows(), 0);
+      assert(false);
+    } catch (const std::out_of_range&) {
+    }
+  }
+  {
+    // The values throw partway through, no element has been moved yet.
+    const ciel::vector<std::string> input = getStringInputsWithLength(40, 20);
+    ciel::matrix<std::string> m = make_matrix<ciel::matrix<std::string>>(input, 4, 5, false);
+    const ciel::matrix<std::string> copy(m);
+
+    auto values = std::views::iota(0, 4) | std::views::transform([&](int r) {
+                    if (r == 2) {
+                      throw 1;
+                    }
+                    return input[r];
+                  });
+    try {
+      m.insert_column(1, values);
+      assert(false);
+    } catch (int) {
+    }
+    assert(m == copy);
+  }
+#endif
+}
+
+int main(int, char**) {
+  test<ciel::matrix<int>>(getIntegerInputs(200));
+  test<ciel::matrix<int, ciel::aligned_allocator<int, 64>>>(getIntegerInputs(200));
+  test<ciel::matrix<std::string>>(getStringInputsWithLength(200, 20));
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  test_padding();
+  test_initializer_list();
+  test_exceptions();
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
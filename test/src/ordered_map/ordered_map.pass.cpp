@@ -0,0 +1,253 @@
+// <ciel/ordered_map.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <ciel/ordered_map.hpp>
+#include <climits>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "count_new.h"
+#include "test_allocator.h"
+#include "test_macros.h"
+
+// Puts every key into few probe chains.
+struct bad_hash {
+  std::size_t operator()(const int x) const noexcept { return static_cast<std::size_t>(x % 7); }
+};
+
+template <class Map>
+void check_order(const Map& m, const std::vector<int>& order, const std::unordered_map<int, int>& model) {
+  assert(m.size() == order.size());
+  assert(m.size() == model.size());
+
+  std::size_t i = 0;
+  for (const auto& [key, value] : m) {
+    assert(key == order[i]);
+    assert(value == model.at(key));
+    ++i;
+  }
+  assert(i == order.size());
+}
+
+template <class Hash>
+void test_random() {
+  ciel::ordered_map<int, int, Hash> m;
+  std::unordered_map<int, int> model;
+  std::vector<int> order;
+  std::mt19937 gen(5);
+
+  for (int i = 0; i < 20000; ++i) {
+    const int key = static_cast<int>(gen() % 500);
+
+    switch (gen() % 4) {
+      case 0:
+      case 1: {
+        const bool inserted = m.insert({key, i}).second;
+        assert(inserted == model.emplace(key, i).second);
+        if (inserted) {
+          order.push_back(key);
+        }
+      } break;
+      case 2: {
+        const std::size_t erased = m.erase(key);
+        assert(erased == model.erase(key));
+        if (erased) {
+          order.erase(std::find(order.begin(), order.end(), key));
+        }
+      } break;
+      default: {
+        const auto it = m.find(key);
+        assert((it == m.end()) == !model.contains(key));
+        if (it != m.end()) {
+          assert(it->first == key);
+          it->second = -i;
+          model[key] = -i;
+        }
+      }
+    }
+
+    if (i % 1000 == 0) {
+      check_order(m, order, model);
+    }
+  }
+
+  check_order(m, order, model);
+
+  // Erase through iterators while iterating, compactions happen along the way.
+  for (auto it = m.begin(); it != m.end();) {
+    if (it->first % 2 == 0) {
+      model.erase(it->first);
+      it = m.erase(it);
+
+    } else {
+      ++it;
+    }
+  }
+  order.erase(std::remove_if(order.begin(), order.end(), [](const int x) { return x % 2 == 0; }), order.end());
+  check_order(m, order, model);
+
+  m.compact();
+  check_order(m, order, model);
+}
+
+void test_basic() {
+  ciel::ordered_map<std::string, int> m{
+      {"zeta",  1},
+      {"alpha", 2},
+      {"mid",   3}
+  };
+  assert(m.size() == 3);
+  assert(m.begin()->first == "zeta");
+  assert(m.at("alpha") == 2);
+  assert(m.contains("mid"));
+  assert(!m.contains("none"));
+  assert(m.count("zeta") == 1);
+
+  m["beta"] = 4;
+  assert(m.size() == 4);
+  assert(!m.try_emplace("beta", 5).second);
+  assert(m["beta"] == 4);
+  assert(!m.insert_or_assign("beta", 6).second);
+  assert(m["beta"] == 6);
+  assert(m.emplace("gamma", 7).second);
+
+  // Re-inserting an erased key appends it at the end.
+  assert(m.erase("zeta") == 1);
+  assert(m.erase("zeta") == 0);
+  m["zeta"] = 8;
+
+  const std::vector<std::string> expected{"alpha", "mid", "beta", "gamma", "zeta"};
+  std::vector<std::string> keys;
+  for (const auto& e : std::as_const(m)) {
+    keys.push_back(e.first);
+  }
+  assert(keys == expected);
+
+#ifdef __cpp_exceptions
+  try {
+    (void)m.at("none");
+    assert(false);
+  } catch (const std::out_of_range&) {
+  }
+#endif
+
+  ciel::ordered_map<std::string, int> copy(m);
+  assert(copy == m);
+  copy.erase("mid");
+  assert(copy != m);
+  copy["mid"] = 3;
+  assert(copy == m);  // order does not matter
+
+  ciel::ordered_map<std::string, int> moved(std::move(copy));
+  assert(moved == m);
+  assert(copy.empty());
+  copy["x"] = 1;
+  assert(copy.size() == 1);
+  assert(copy.begin()->first == "x");
+
+  m.clear();
+  assert(m.empty());
+  assert(m.begin() == m.end());
+  m["after"] = 1;
+  assert(m.size() == 1);
+}
+
+void test_index_width() {
+  ciel::ordered_map<int, int> m;
+  m[0] = 0;
+  assert(m.index_width() == 1);
+
+  for (int i = 1; i < 1000; ++i) {
+    m[i] = i;
+  }
+  assert(m.index_width() == 2);
+
+  m.reserve(100000);
+  assert(m.index_width() == 4);
+
+  for (int i = 0; i < 1000; ++i) {
+    assert(m.at(i) == i);
+  }
+  assert(m.begin()->first == 0);
+}
+
+// The mapped value is copied from an existing entry while the map grows and compacts.
+void test_self_reference() {
+  for (int n = 2; n < 40; ++n) {
+    ciel::ordered_map<int, std::string> m;
+    for (int i = 0; i < n; ++i) {
+      m.try_emplace(i, std::to_string(i) + std::string(30, 'v'));
+    }
+    m.erase(0);
+
+    const auto res = m.try_emplace(1000, m.find(n - 1)->second);
+    assert(res.second);
+    assert(res.first->first == 1000);
+    assert(res.first->second == std::to_string(n - 1) + std::string(30, 'v'));
+    assert(m.at(1000) == res.first->second);
+    assert(m.size() == static_cast<std::size_t>(n));
+  }
+}
+
+// Every allocation of an insertion fails in turn, the map is left as it was each time.
+void test_allocation_failure() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  using Map = ciel::ordered_map<int, std::string, std::hash<int>, std::equal_to<int>,
+                                test_allocator<std::pair<int, std::string>>>;
+
+  test_allocator_statistics stats;
+  {
+    Map m(0, std::hash<int>(), std::equal_to<int>(), test_allocator<std::pair<int, std::string>>(&stats));
+
+    for (int key = 0; key < 300; ++key) {
+      // Some tombstones, so that growing compacts too.
+      if (key % 3 == 2) {
+        m.erase(key - 1);
+      }
+
+      const std::vector<std::pair<int, std::string>> before(m.begin(), m.end());
+
+      for (int fail = 0;; ++fail) {
+        stats.throw_after = stats.time_to_throw + fail;
+        try {
+          m.try_emplace(key, std::to_string(key));
+          break;
+        } catch (const std::bad_alloc&) {
+        }
+
+        stats.throw_after = INT_MAX;
+        assert(m.size() == before.size());
+        assert(std::equal(m.begin(), m.end(), before.begin(), before.end()));
+        for (const auto& e : before) {
+          assert(m.at(e.first) == e.second);
+        }
+        assert(!m.contains(key));
+      }
+      stats.throw_after = INT_MAX;
+
+      assert(m.size() == before.size() + 1);
+      assert(m.at(key) == std::to_string(key));
+    }
+  }
+  assert(stats.alloc_count == 0);
+#endif
+}
+
+int main(int, char**) {
+  test_basic();
+  test_index_width();
+  test_self_reference();
+  test_allocation_failure();
+  test_random<std::hash<int>>();
+  test_random<bad_hash>();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
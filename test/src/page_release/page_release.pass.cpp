@@ -0,0 +1,97 @@
+// <ciel/page_release.hpp>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <ciel/page_release.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "count_new.h"
+
+namespace {
+
+// Number of resident pages among the whole pages in [first, last).
+size_t resident_pages(const void* first, const void* last) {
+  const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t begin = (reinterpret_cast<uintptr_t>(first) + page_size - 1) / page_size * page_size;
+  const uintptr_t end = reinterpret_cast<uintptr_t>(last) / page_size * page_size;
+
+  if (begin >= end) {
+    return 0;
+  }
+
+  ciel::vector<unsigned char> status((end - begin) / page_size);
+#ifdef __APPLE__
+  const int res = mincore(reinterpret_cast<void*>(begin), end - begin, reinterpret_cast<char*>(status.data()));
+#else
+  const int res = mincore(reinterpret_cast<void*>(begin), end - begin, status.data());
+#endif
+  assert(res == 0);
+
+  size_t count = 0;
+  for (const unsigned char s : status) {
+    count += s & 1;
+  }
+
+  return count;
+}
+
+constexpr size_t bytes = size_t{16} << 20;
+
+}  // namespace
+
+void test_clear_and_release() {
+  ciel::vector<unsigned char> v(bytes, 1);
+  const unsigned char* data = v.data();
+  assert(resident_pages(data, data + bytes) > 0);
+
+  const size_t released = ciel::clear_and_release(v);
+  assert(released > bytes - 2 * static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+  assert(v.empty());
+  assert(v.capacity() == bytes);
+  assert(v.data() == data);
+  assert(resident_pages(data, data + bytes) == 0);
+
+  // The buffer is reused without reallocating.
+  v.resize(bytes, 2);
+  assert(v.data() == data);
+  assert(v[0] == 2);
+  assert(v[bytes - 1] == 2);
+}
+
+void test_shrink_pages() {
+  ciel::vector<uint64_t> v(bytes / sizeof(uint64_t));
+  for (size_t i = 0; i < v.size(); ++i) {
+    v[i] = i;
+  }
+
+  v.resize(1000);
+  ciel::shrink_pages(v, ciel::page_release::lazy);
+  ciel::shrink_pages(v);
+  assert(v.capacity() == bytes / sizeof(uint64_t));
+  assert(resident_pages(v.data() + v.size(), v.data() + v.capacity()) == 0);
+
+  // Elements in use are untouched, including those sharing a page with the released range.
+  for (size_t i = 0; i < v.size(); ++i) {
+    assert(v[i] == i);
+  }
+}
+
+void test_nothing_to_release() {
+  ciel::vector<int> empty;
+  assert(ciel::shrink_pages(empty) == 0);
+
+  ciel::vector<int> small(10);
+  assert(ciel::clear_and_release(small) == 0);
+  assert(small.capacity() == 10);
+}
+
+int main() {
+  test_clear_and_release();
+  test_shrink_pages();
+  test_nothing_to_release();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
@@ -0,0 +1,294 @@
+// <ciel/persistent_vector.hpp>
+
+// persistent_vector push_back(const value_type& value) const;
+// persistent_vector set(size_type pos, U&& value) const;
+// persistent_vector concat(const persistent_vector& other) const;
+// persistent_vector take(size_type count) const;
+// persistent_vector drop(size_type count) const;
+// persistent_vector slice(size_type first, size_type last) const;
+// transient_type transient() const&;
+
+#include <algorithm>
+#include <cassert>
+#include <ciel/persistent_vector.hpp>
+#include <cstddef>
+#include <random>
+#include <string>
+
+#include "../common.h"
+#include "count_new.h"
+#include "test_macros.h"
+
+template <class C, class Model>
+void check_equal(const C& v, const Model& m) {
+  assert(v.size() == m.size());
+  assert(v.empty() == m.empty());
+
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    assert(v[i] == m[i]);
+  }
+
+  assert(std::equal(v.begin(), v.end(), m.begin(), m.end()));
+  assert(std::equal(v.rbegin(), v.rend(), m.rbegin(), m.rend()));
+}
+
+template <class C>
+void test_push_back(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  C v;
+  ciel::vector<C> versions;
+
+  for (std::size_t i = 0; i < 200; ++i) {
+    versions.push_back(v);
+    v = v.push_back(input[i]);
+  }
+
+  // Older versions are not affected by later push_backs.
+  for (std::size_t i = 0; i < versions.size(); ++i) {
+    check_equal(versions[i], ciel::vector<T>(input.begin(), input.begin() + i));
+  }
+
+  const C w = v.set(100, input[300]);
+  assert(v[100] == input[100]);
+  assert(w[100] == input[300]);
+  assert(w.set(100, input[100]) == v);
+}
+
+template <class C>
+void test_random(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  std::mt19937 gen(42);
+  C v;
+  ciel::vector<T> m;
+
+  for (std::size_t round = 0; round < 300; ++round) {
+    switch (gen() % 4) {
+      case 0: {  // concat
+        const std::size_t n = gen() % 40;
+        C r;
+        ciel::vector<T> rm;
+        for (std::size_t i = 0; i < n; ++i) {
+          r = r.push_back(input[(round + i) % input.size()]);
+          rm.push_back(input[(round + i) % input.size()]);
+        }
+
+        const C old = v;
+        v = v.concat(r);
+        m.insert(m.end(), rm.begin(), rm.end());
+        check_equal(r, rm);
+        assert(old.size() + r.size() == v.size());
+        break;
+      }
+      case 1: {  // slice
+        if (m.empty()) {
+          break;
+        }
+        const std::size_t first = gen() % m.size();
+        const std::size_t last = first + gen() % (m.size() - first + 1);
+        v = v.slice(first, last);
+        m.erase(m.begin() + last, m.end());
+        m.erase(m.begin(), m.begin() + first);
+        break;
+      }
+      case 2: {  // self concat
+        if (m.size() > 1000) {
+          break;
+        }
+        v = v.concat(v);
+        const ciel::vector<T> copy = m;
+        m.insert(m.end(), copy.begin(), copy.end());
+        break;
+      }
+      default: {  // set
+        if (m.empty()) {
+          break;
+        }
+        const std::size_t pos = gen() % m.size();
+        v = v.set(pos, input[round]);
+        m[pos] = input[round];
+        break;
+      }
+    }
+
+    check_equal(v, m);
+  }
+}
+
+template <class C>
+void test_transient(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  typename C::transient_type t;
+  for (std::size_t i = 0; i < 500; ++i) {
+    t.push_back(input[i]);
+  }
+
+  const C snapshot = std::move(t).persistent();
+  check_equal(snapshot, ciel::vector<T>(input.begin(), input.begin() + 500));
+
+  typename C::transient_type t2 = snapshot.transient();
+  for (std::size_t i = 0; i < 500; i += 3) {
+    t2.set(i, input[i + 1]);
+  }
+  t2.append(C(input.begin(), input.begin() + 37));
+  t2.drop(5);
+  t2.take(400);
+  t2.pop_back();
+  const C v2 = std::move(t2).persistent();
+
+  // The snapshot is untouched.
+  check_equal(snapshot, ciel::vector<T>(input.begin(), input.begin() + 500));
+
+  ciel::vector<T> m(input.begin(), input.begin() + 500);
+  for (std::size_t i = 0; i < 500; i += 3) {
+    m[i] = input[i + 1];
+  }
+  m.insert(m.end(), input.begin(), input.begin() + 37);
+  m.erase(m.begin() + 404, m.end());
+  m.erase(m.begin(), m.begin() + 5);
+  check_equal(v2, m);
+}
+
+// Elements of the vector itself as the new value, with leaves that are shared and leaves that are not.
+template <class C>
+void test_self_reference(const ciel::vector<typename C::value_type>& input) {
+  using T = typename C::value_type;
+
+  {
+    C v(input.begin(), input.begin() + 10);
+    ciel::vector<T> m(input.begin(), input.begin() + 10);
+
+    for (std::size_t i = 0; i < 50; ++i) {
+      v = v.push_back(v[i]);
+      m.push_back(m[i]);
+      v = v.set(i, v.back());
+      m[i] = m.back();
+    }
+    check_equal(v, m);
+  }
+  {
+    const C shared(input.begin(), input.begin() + 10);
+    typename C::transient_type t = shared.transient();
+    ciel::vector<T> m(input.begin(), input.begin() + 10);
+
+    for (std::size_t i = 0; i < 50; ++i) {
+      t.push_back(t[i]);
+      m.push_back(m[i]);
+      t.set(i, t[t.size() - 1]);
+      m[i] = m.back();
+    }
+
+    check_equal(std::move(t).persistent(), m);
+    check_equal(shared, ciel::vector<T>(input.begin(), input.begin() + 10));
+  }
+}
+
+template <class C>
+void test_access(const ciel::vector<typename C::value_type>& input) {
+  const C v{input[1], input[2], input[3]};
+  assert(v.front() == input[1]);
+  assert(v.back() == input[3]);
+  assert(v.at(1) == input[2]);
+  assert(v.take(2).size() == 2);
+  assert(v.drop(3).empty());
+  assert(v.slice(1, 1).empty());
+  assert(v.take(0).empty());
+
+  const C n(5, input[4]);
+  assert(n.size() == 5);
+  assert(n[4] == input[4]);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    (void)v.at(3);
+    assert(false);
+  } catch (const std::out_of_range&) {
+  }
+#endif
+}
+
+template <class C>
+void test(const ciel::vector<typename C::value_type>& input) {
+  test_push_back<C>(input);
+  test_random<C>(input);
+  test_transient<C>(input);
+  test_self_reference<C>(input);
+  test_access<C>(input);
+}
+
+// A copy throws partway through a leaf, the vector that was modified is left as it was.
+void test_exceptions() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  using T = throwing_data<int>;
+  using C = ciel::persistent_vector<T, 4>;
+
+  int throw_after_n = 1000;
+  typename C::transient_type t;
+  for (int i = 0; i < 30; ++i) {
+    t.push_back(T(i, throw_after_n));
+  }
+  const C v = std::move(t).persistent();
+  const C copy = v;
+
+  // The last leaf is shared with copy, so it is copied before the new element is added.
+  throw_after_n = 1;
+  try {
+    (void)v.push_back(v[0]);
+    assert(false);
+  } catch (int) {
+  }
+  assert(v == copy);
+
+  throw_after_n = 2;
+  try {
+    (void)v.set(5, v[0]);
+    assert(false);
+  } catch (int) {
+  }
+  assert(v == copy);
+
+  typename C::transient_type t2 = v.transient();
+  for (int n = 0; n < 3; ++n) {
+    throw_after_n = n;
+    try {
+      t2.push_back(v[0]);
+      assert(false);
+    } catch (int) {
+    }
+    assert(t2.size() == v.size());
+  }
+
+  throw_after_n = 1000;
+  const C v2 = std::move(t2).persistent();
+  assert(v2 == v);
+  assert(v == copy);
+#endif
+}
+
+int main(int, char**) {
+  {
+    test<ciel::persistent_vector<int, 4>>(getIntegerInputs(1000));
+    test<ciel::persistent_vector<std::string, 4>>(getStringInputsWithLength(1000, 40));
+    test_exceptions();
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+  {
+    // Default branching factor.
+    ciel::persistent_vector<std::size_t> v;
+    auto t = v.transient();
+    for (std::size_t i = 0; i < 100000; ++i) {
+      t.push_back(i);
+    }
+    v = std::move(t).persistent();
+
+    const auto w = v.concat(v).slice(50000, 150000);
+    for (std::size_t i = 0; i < w.size(); ++i) {
+      assert(w[i] == (i + 50000) % 100000);
+    }
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
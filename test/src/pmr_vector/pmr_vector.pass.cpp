@@ -0,0 +1,97 @@
+// <ciel/vector.hpp>
+
+#include <cassert>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include "count_new.h"
+
+namespace {
+
+struct point {
+  int x;
+  int y;
+};
+
+using alloc = std::pmr::polymorphic_allocator<int>;
+
+}  // namespace
+
+static_assert(std::is_same_v<ciel::pmr::vector<int>, ciel::vector<int, std::pmr::polymorphic_allocator<int>>>);
+
+// Objects that don't take an allocator are constructed as with std::allocator, so the memcpy paths apply.
+static_assert(ciel::allocator_has_trivial_construct<alloc, int*>::value);
+static_assert(ciel::allocator_has_trivial_construct<alloc, point*, const point&>::value);
+static_assert(ciel::allocator_has_trivial_construct<alloc, std::string*, std::string&&>::value);
+static_assert(ciel::allocator_has_trivial_destroy<alloc, point*>::value);
+
+// Allocator-aware objects receive the memory resource.
+static_assert(!ciel::allocator_has_trivial_construct<alloc, std::pmr::string*, const std::pmr::string&>::value);
+static_assert(!ciel::allocator_has_trivial_construct<alloc, ciel::pmr::vector<int>*>::value);
+static_assert(!ciel::allocator_has_trivial_construct<alloc, std::pair<int, std::pmr::string>*>::value);
+
+void test_trivial() {
+  std::byte buffer[1 << 16];
+  std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  const int new_called = globalMemCounter.new_called;
+
+  ciel::pmr::vector<point> v(&resource);
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back({i, -i});
+  }
+
+  v.insert(v.begin(), 10, point{7, 7});
+  v.erase(v.begin() + 5, v.begin() + 15);
+  assert(v.size() == 1000);
+  assert(v[4].x == 7);
+  assert(v[5].x == 5);
+  assert(v[999].y == -999);
+
+  ciel::pmr::vector<point> copy(v);
+  assert(copy.get_allocator().resource() == std::pmr::get_default_resource());
+
+  ciel::pmr::vector<point> same(v, &resource);
+  assert(same.size() == 1000);
+
+  assert(globalMemCounter.checkNewCalledEq(new_called + 1));  // only the default resource copy
+}
+
+void test_allocator_aware() {
+  std::pmr::monotonic_buffer_resource resource;
+
+  ciel::pmr::vector<std::pmr::string> strings(&resource);
+  for (int i = 0; i < 100; ++i) {
+    strings.emplace_back(100, static_cast<char>('a' + i % 26));
+  }
+
+  strings.insert(strings.begin(), std::pmr::string(100, 'z'));
+  for (const std::pmr::string& s : strings) {
+    assert(s.get_allocator().resource() == &resource);
+  }
+  assert(strings[0][0] == 'z');
+  assert(strings[1][0] == 'a');
+
+  ciel::pmr::vector<ciel::pmr::vector<int>> nested(&resource);
+  nested.emplace_back(10, 1);
+  nested.emplace_back(20, 2);
+  nested.insert(nested.begin(), ciel::pmr::vector<int>(5, 0));
+  for (const ciel::pmr::vector<int>& inner : nested) {
+    assert(inner.get_allocator().resource() == &resource);
+  }
+  assert(nested[2].size() == 20);
+
+  ciel::pmr::vector<std::pair<int, std::pmr::string>> pairs(&resource);
+  pairs.emplace_back(1, "a long string that needs the heap, not the small buffer");
+  assert(pairs[0].second.get_allocator().resource() == &resource);
+}
+
+int main() {
+  test_trivial();
+  test_allocator_aware();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
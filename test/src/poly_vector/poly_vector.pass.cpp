@@ -0,0 +1,179 @@
+// <ciel/poly_vector.hpp>
+
+#include <cassert>
+#include <ciel/poly_vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "count_new.h"
+
+namespace {
+
+int alive = 0;
+
+struct handler {
+  handler() noexcept { ++alive; }
+  handler(const handler&) noexcept { ++alive; }
+  handler(handler&&) noexcept { ++alive; }
+  virtual ~handler() { --alive; }
+
+  virtual int handle(int x) const = 0;
+};
+
+struct add final : handler {
+  int n;
+
+  explicit add(int n_) noexcept : n{n_} {}
+
+  int handle(int x) const override { return x + n; }
+};
+
+// Not trivially relocatable by default, goes through the relocate thunk.
+struct append final : handler {
+  std::string s;
+
+  explicit append(std::string s_) : s{std::move(s_)} {}
+
+  int handle(int x) const override { return x + static_cast<int>(s.size()); }
+};
+
+struct alignas(16) aligned final : handler {
+  double d[3]{1, 2, 3};
+
+  int handle(int x) const override {
+    assert(reinterpret_cast<std::uintptr_t>(this) % 16 == 0);
+    return x * 2 + static_cast<int>(d[2]);
+  }
+};
+
+struct other_base {
+  long long tag{7};
+  virtual ~other_base() = default;
+};
+
+// handler is not the first base, so the Base subobject is not at the start of the object.
+struct second final : other_base, handler {
+  int handle(int x) const override { return x - static_cast<int>(tag); }
+};
+
+}  // namespace
+
+template <>
+struct ciel::is_trivially_relocatable<add> : std::true_type {};
+
+template <>
+struct ciel::is_trivially_relocatable<aligned> : std::true_type {};
+
+int expected(int i, int x) {
+  switch (i % 4) {
+    case 0:
+      return x + i;
+    case 1:
+      return x + static_cast<int>(std::to_string(i).size()) + 30;
+    case 2:
+      return x * 2 + 3;
+    default:
+      return x - 7;
+  }
+}
+
+void test() {
+  ciel::poly_vector<handler> v;
+  assert(v.empty());
+
+  for (int i = 0; i < 1000; ++i) {
+    switch (i % 4) {
+      case 0:
+        v.emplace_back<add>(i);
+        break;
+      case 1:
+        v.emplace_back<append>(std::to_string(i) + std::string(30, 'x'));
+        break;
+      case 2:
+        v.emplace_back<aligned>();
+        break;
+      default:
+        v.emplace_back<second>();
+    }
+
+    assert(alive == i + 1);
+  }
+  assert(v.size() == 1000);
+
+  int i = 0;
+  for (const handler& h : v) {
+    assert(h.handle(5) == expected(i, 5));
+    ++i;
+  }
+
+  // Objects are laid out in order in memory.
+  for (std::size_t j = 1; j < v.size(); ++j) {
+    assert(reinterpret_cast<std::uintptr_t>(&v[j - 1]) < reinterpret_cast<std::uintptr_t>(&v[j]));
+  }
+
+  v.pop_back();
+  v.pop_back();
+  assert(alive == 998);
+  assert(v.back().handle(1) == expected(997, 1));
+  v.emplace_back<add>(1);
+  assert(v.back().handle(1) == 2);
+
+  ciel::poly_vector<handler> moved(std::move(v));
+  assert(v.empty());
+  assert(moved.size() == 999);
+  assert(moved[4].handle(0) == expected(4, 0));
+
+  v = std::move(moved);
+  assert(v.size() == 999);
+
+  v.clear();
+  assert(alive == 0);
+  assert(v.bytes() == 0);
+}
+
+void test_all_trivial() {
+  ciel::poly_vector<handler> v;
+  v.reserve(10, 10 * sizeof(add));
+  const std::size_t cap = v.capacity_bytes();
+
+  for (int i = 0; i < 10; ++i) {
+    v.emplace_back<add>(i);
+  }
+  assert(v.capacity_bytes() == cap);
+
+  // Relocated with one memcpy.
+  for (int i = 10; i < 1000; ++i) {
+    v.emplace_back<add>(i);
+  }
+
+  for (int j = 0; j < 1000; ++j) {
+    assert(v[j].handle(0) == j);
+  }
+}
+
+// Copying an element of the vector itself across a reallocation.
+void test_self_emplace() {
+  ciel::poly_vector<handler> v;
+  v.emplace_back<append>(std::string(40, 'x'));
+
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back<append>(static_cast<const append&>(v[0]));
+  }
+
+  for (const handler& h : v) {
+    assert(h.handle(0) == 40);
+  }
+}
+
+int main(int, char**) {
+  test();
+  test_all_trivial();
+  test_self_emplace();
+
+  assert(alive == 0);
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
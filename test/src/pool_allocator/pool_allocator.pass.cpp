@@ -0,0 +1,116 @@
+// <ciel/pool_allocator.hpp>
+
+#include <cassert>
+#include <ciel/pool_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "count_new.h"
+
+namespace {
+
+struct holder {
+  ciel::pool_vector<int> v;
+};
+
+// Destroyed after the main thread's cache.
+ciel::pool_vector<int> static_vector;
+
+}  // namespace
+
+static_assert(ciel::allocator_has_trivial_construct<ciel::pool_allocator<int>, int*, const int&>::value);
+static_assert(ciel::allocator_has_trivial_destroy<ciel::pool_allocator<int>, int*>::value);
+
+void test_recycle() {
+  ciel::pool_cache& cache = ciel::pool_cache::local();
+  assert(cache.cached_blocks() == 0);
+
+  const int* first = nullptr;
+  {
+    ciel::pool_vector<int> v;
+    for (int i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+
+    first = v.data();
+    assert(cache.cached_blocks() > 0);  // the smaller buffers it outgrew
+  }
+
+  // The same growth is served from the cache, without operator new.
+  const int new_called = globalMemCounter.new_called;
+  {
+    ciel::pool_vector<int> v;
+    for (int i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+
+    assert(v.data() == first);
+    assert(v[999] == 999);
+  }
+  assert(globalMemCounter.checkNewCalledEq(new_called));
+}
+
+void test_non_trivial() {
+  ciel::pool_vector<std::string> v;
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(50, static_cast<char>('a' + i % 26));
+  }
+
+  ciel::pool_vector<std::string> copy(v);
+  v.erase(v.begin(), v.begin() + 50);
+  assert(v.size() == 50);
+  assert(v[0] == copy[50]);
+}
+
+void test_large() {
+  ciel::pool_vector<std::byte> v(ciel::pool_cache::max_class_bytes + 1);
+  assert(v.size() == ciel::pool_cache::max_class_bytes + 1);
+}
+
+void test_threads() {
+  ciel::pool_vector<uint64_t> shared;
+  shared.resize(100);
+
+  std::thread t([&] {
+    // Freed here, cached by this thread and released when it exits.
+    ciel::pool_vector<uint64_t> moved(std::move(shared));
+
+    for (int round = 0; round < 100; ++round) {
+      ciel::pool_vector<uint64_t> v;
+      for (uint64_t i = 0; i < 100; ++i) {
+        v.push_back(i);
+      }
+    }
+  });
+  t.join();
+
+  assert(shared.empty());
+}
+
+// A thread_local constructed before the cache is destroyed after it, its buffer goes back to operator delete.
+void test_thread_exit() {
+  std::thread t([] {
+    static thread_local holder h;
+    for (int i = 0; i < 1000; ++i) {
+      h.v.push_back(i);
+    }
+  });
+  t.join();
+}
+
+int main() {
+  test_recycle();
+  test_non_trivial();
+  test_large();
+  test_threads();
+  test_thread_exit();
+
+  ciel::pool_cache::local().trim();
+  assert(ciel::pool_cache::local().cached_blocks() == 0);
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  static_vector.resize(1000);
+}
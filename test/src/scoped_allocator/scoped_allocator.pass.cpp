@@ -0,0 +1,100 @@
+// <ciel/vector.hpp>
+
+#include <cassert>
+#include <ciel/arena_allocator.hpp>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <memory>
+#include <scoped_allocator>
+#include <utility>
+
+#include "count_new.h"
+#include "test_allocator.h"
+
+namespace {
+
+using inner = ciel::arena_vector<int>;
+using outer_alloc = std::scoped_allocator_adaptor<ciel::arena_allocator<inner>>;
+using nested = ciel::vector<inner, outer_alloc>;
+
+template <class T>
+using scoped = std::scoped_allocator_adaptor<std::allocator<T>>;
+
+}  // namespace
+
+// Inner vectors are relocated with memcpy, others as with the outer allocator.
+static_assert(nested::expand_via_memcpy);
+static_assert(nested::move_via_memmove);
+static_assert(ciel::vector<int, scoped<int>>::expand_via_memcpy);
+static_assert(ciel::vector<ciel::vector<int>, scoped<ciel::vector<int>>>::expand_via_memcpy);
+static_assert(!ciel::vector<ciel::vector<int>, std::scoped_allocator_adaptor<test_allocator<ciel::vector<int>>>>::
+                  expand_via_memcpy);
+
+// Constructing an inner vector from arguments still passes it the inner allocator.
+static_assert(!ciel::allocator_has_trivial_construct<outer_alloc, inner*>::value);
+static_assert(ciel::allocator_has_trivial_construct<scoped<int>, int*, const int&>::value);
+static_assert(ciel::allocator_has_trivial_destroy<outer_alloc, inner*>::value);
+
+void test_arena() {
+  ciel::monotonic_arena arena;
+
+  {
+    nested v(arena);
+
+    for (int i = 0; i < 100; ++i) {
+      inner& in = v.emplace_back();
+      assert(&in.get_allocator().arena() == &arena);
+
+      for (int j = 0; j < i; ++j) {
+        in.push_back(j);
+      }
+    }
+
+    const int* data50 = v[50].data();
+
+    // Growth, insertion and erasure move the inner vectors without touching their buffers.
+    v.reserve(v.capacity() * 2);
+    v.insert(v.begin(), inner(arena));
+    v.emplace(v.begin() + 10, 5, 1);
+    v.erase(v.begin() + 20, v.begin() + 30);
+
+    assert(v.size() == 92);
+    assert(v[0].empty());
+    assert(v[10] == inner({1, 1, 1, 1, 1}, arena));
+    assert(v[50 - 8].data() == data50);
+
+    for (const inner& in : v) {
+      assert(&in.get_allocator().arena() == &arena);
+    }
+
+    for (int i = 20; i < 92; ++i) {
+      assert(v[i].size() == static_cast<size_t>(i + 8));
+    }
+  }
+
+  arena.reset();
+}
+
+void test_std_allocator() {
+  ciel::vector<ciel::vector<int>, scoped<ciel::vector<int>>> v;
+
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(i, i);
+  }
+
+  v.erase(v.begin(), v.begin() + 50);
+  v.insert(v.begin() + 25, ciel::vector<int>(3, -1));
+  v.shrink_to_fit();
+
+  assert(v.size() == 51);
+  assert(v[0] == ciel::vector<int>(50, 50));
+  assert(v[25] == ciel::vector<int>(3, -1));
+  assert(v[50] == ciel::vector<int>(99, 99));
+}
+
+int main() {
+  test_arena();
+  test_std_allocator();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
@@ -0,0 +1,216 @@
+// <ciel/serialize.hpp>
+
+#include <unistd.h>
+
+#include <cassert>
+#include <ciel/aligned_allocator.hpp>
+#include <ciel/serialize.hpp>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <stdexcept>
+
+#include "count_new.h"
+
+namespace {
+
+struct alignas(16) vec4 {
+  float x, y, z, w;
+};
+
+bool operator==(const vec4& lhs, const vec4& rhs) {
+  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z && lhs.w == rhs.w;
+}
+
+}  // namespace
+
+void test_flat() {
+  ciel::vector<uint32_t> v;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    v.push_back(i * 7);
+  }
+
+  ciel::vector<std::byte> out;
+  ciel::serialize(v, out);
+  assert(out.size() == ciel::serialized_size(v));
+  assert(out.size() == sizeof(ciel::serialized_header) + 1000 * sizeof(uint32_t));
+
+  std::span<const std::byte> in(out.data(), out.size());
+  const auto v2 = ciel::deserialize<ciel::vector<uint32_t>>(in);
+  assert(in.empty());
+  assert(v2 == v);
+  assert(v2.capacity() == v2.size());
+
+  // Views alias the buffer.
+  in = std::span<const std::byte>(out.data(), out.size());
+  const std::span<const uint32_t> view = ciel::deserialize_view<uint32_t>(in);
+  assert(in.empty());
+  assert(view.size() == 1000);
+  assert(reinterpret_cast<const std::byte*>(view.data()) == out.data() + sizeof(ciel::serialized_header));
+  assert(view[999] == 999 * 7);
+}
+
+void test_alignment_and_concatenation() {
+  const ciel::vector<uint8_t> a{1, 2, 3};
+  const ciel::vector<vec4> b{{1, 2, 3, 4}, {5, 6, 7, 8}};
+  const ciel::vector<vec4> empty;
+
+  ciel::aligned_vector<std::byte, 64> out;
+  ciel::serialize(a, out);
+  ciel::serialize(b, out);
+  ciel::serialize(empty, out);
+
+  std::span<const std::byte> in(out.data(), out.size());
+  assert(ciel::deserialize<ciel::vector<uint8_t>>(in) == a);
+
+  // The payload is aligned relative to the start of the output.
+  const std::span<const vec4> view = ciel::deserialize_view<vec4>(in);
+  assert(reinterpret_cast<uintptr_t>(view.data()) % alignof(vec4) == 0);
+  assert(view.size() == 2);
+  assert(view[1] == (vec4{5, 6, 7, 8}));
+
+  assert(ciel::deserialize<ciel::vector<vec4>>(in).empty());
+  assert(in.empty());
+}
+
+// Many small vectors into one output reallocate it a logarithmic number of times.
+void test_many_appends() {
+  const ciel::vector<uint32_t> v{1, 2, 3};
+
+  ciel::vector<std::byte> out;
+  int reallocations = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const std::byte* data = out.data();
+    ciel::serialize(v, out);
+    reallocations += out.data() != data;
+  }
+  assert(reallocations < 20);
+
+  std::span<const std::byte> in(out.data(), out.size());
+  for (int i = 0; i < 1000; ++i) {
+    assert(ciel::deserialize<ciel::vector<uint32_t>>(in) == v);
+  }
+  assert(in.empty());
+}
+
+void test_nested() {
+  ciel::vector<ciel::vector<int64_t>> v;
+  for (int64_t i = 0; i < 50; ++i) {
+    v.emplace_back();
+    for (int64_t j = 0; j < i; ++j) {
+      v.back().emplace_back(i * j);
+    }
+  }
+
+  ciel::vector<ciel::vector<ciel::vector<char>>> vv{{{'a', 'b'}, {}}, {}, {{'c'}}};
+
+  ciel::vector<std::byte> out;
+  ciel::serialize(v, out);
+  ciel::serialize(vv, out);
+
+  std::span<const std::byte> in(out.data(), out.size());
+  assert(ciel::deserialize<ciel::vector<ciel::vector<int64_t>>>(in) == v);
+  assert((ciel::deserialize<ciel::vector<ciel::vector<ciel::vector<char>>>>(in) == vv));
+  assert(in.empty());
+}
+
+void test_errors() {
+  const ciel::vector<uint32_t> v{1, 2, 3};
+
+  ciel::vector<std::byte> out;
+  ciel::serialize(v, out);
+
+#ifdef __cpp_exceptions
+  // Another type.
+  try {
+    std::span<const std::byte> in(out.data(), out.size());
+    static_cast<void>(ciel::deserialize<ciel::vector<uint64_t>>(in));
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+
+  try {
+    std::span<const std::byte> in(out.data(), out.size());
+    static_cast<void>(ciel::deserialize<ciel::vector<ciel::vector<uint32_t>>>(in));
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+
+  // Truncated.
+  try {
+    std::span<const std::byte> in(out.data(), out.size() - 1);
+    static_cast<void>(ciel::deserialize<ciel::vector<uint32_t>>(in));
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+
+  // Misaligned view.
+  ciel::vector<std::byte> shifted{std::byte{0}};
+  ciel::serialize(v, shifted);
+  shifted.erase(shifted.begin());
+
+  {
+    // Still fine to copy out.
+    std::span<const std::byte> in(shifted.data(), shifted.size());
+    assert(ciel::deserialize<ciel::vector<uint32_t>>(in) == v);
+  }
+
+  try {
+    std::span<const std::byte> in(shifted.data(), shifted.size());
+    static_cast<void>(ciel::deserialize_view<uint32_t>(in));
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+
+  // Garbage.
+  try {
+    std::span<const std::byte> in(out.data() + 1, out.size() - 1);
+    static_cast<void>(ciel::deserialize<ciel::vector<uint32_t>>(in));
+    assert(false);
+  } catch (const std::runtime_error&) {
+  }
+#endif
+}
+
+void test_fd() {
+  std::FILE* file = std::tmpfile();
+  assert(file != nullptr);
+  const int fd = fileno(file);
+
+  ciel::vector<vec4> v;
+  for (int i = 0; i < 10000; ++i) {
+    v.push_back({float(i), 1, 2, 3});
+  }
+
+  const ciel::vector<ciel::vector<uint16_t>> nested{{1, 2}, {3}};
+
+  const ssize_t n = ciel::serialize_to_fd(fd, v);
+  assert(n > 0 && static_cast<size_t>(n) == ciel::serialized_size(v));
+  assert(ciel::serialize_to_fd(fd, nested) > 0);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+
+  ciel::aligned_vector<std::byte, 64> bytes;
+  assert(ciel::append_all_from_fd(bytes, fd) > 0);
+
+  std::span<const std::byte> in(bytes.data(), bytes.size());
+  assert(ciel::deserialize_view<vec4>(in).size() == 10000);
+  assert((ciel::deserialize<ciel::vector<ciel::vector<uint16_t>>>(in) == nested));
+  assert(in.empty());
+
+  std::fclose(file);
+}
+
+int main(int, char**) {
+  test_flat();
+  test_alignment_and_concatenation();
+  test_many_appends();
+  test_nested();
+  test_errors();
+  test_fd();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
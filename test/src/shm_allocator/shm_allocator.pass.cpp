@@ -0,0 +1,185 @@
+// <ciel/shm_allocator.hpp>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <ciel/offset_ptr.hpp>
+#include <ciel/shm_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "count_new.h"
+#include "min_allocator.h"
+
+static_assert(std::contiguous_iterator<ciel::offset_ptr<int>>);
+static_assert(std::contiguous_iterator<ciel::offset_ptr<const int>>);
+static_assert(ciel::is_contiguous_iterator_v<ciel::shm_allocator<int>, ciel::offset_ptr<int>>);
+static_assert(!ciel::is_trivially_relocatable_v<ciel::shm_vector<int>>);
+
+// Fancy pointers that only claim random access still get the memcpy paths.
+static_assert(ciel::is_contiguous_iterator_v<min_allocator<int>, min_pointer<int>>);
+static_assert(ciel::is_contiguous_iterator_v<min_allocator<int>, min_pointer<const int>>);
+
+namespace {
+
+struct tables {
+  ciel::shm_vector<uint64_t> keys;
+  ciel::shm_vector<ciel::shm_vector<int>> groups;
+
+  explicit tables(const ciel::shm_allocator<uint64_t>& alloc) : keys(alloc), groups(alloc) {}
+};
+
+}  // namespace
+
+void test_offset_ptr() {
+  int arr[4]{1, 2, 3, 4};
+
+  ciel::offset_ptr<int> p;
+  assert(!p);
+  assert(p == nullptr);
+
+  p = arr;
+  assert(p.get() == arr);
+  assert(*p == 1);
+  assert(p[3] == 4);
+
+  // Copies point at the same object from a different location.
+  ciel::offset_ptr<int> copies[2]{p, p + 2};
+  assert(copies[0] == p);
+  assert(*copies[1] == 3);
+  assert(copies[1] - copies[0] == 2);
+  assert(copies[0] < copies[1]);
+
+  ++copies[0];
+  assert(*copies[0] == 2);
+  assert(std::to_address(copies[0]) == arr + 1);
+
+  const ciel::offset_ptr<const int> cp = copies[1];
+  assert(*cp == 3);
+
+  const ciel::offset_ptr<void> vp = p;
+  assert(static_cast<ciel::offset_ptr<int>>(vp) == p);
+  assert(ciel::offset_ptr<int>::pointer_to(arr[2]) == cp);
+}
+
+void test_vector_in_segment() {
+  ciel::shm_segment segment(size_t{64} << 20);
+  const size_t initial_free = segment.arena().free_bytes();
+
+  {
+    tables& t = segment.construct_root<tables>(ciel::shm_allocator<uint64_t>(segment));
+
+    for (uint64_t i = 0; i < 100000; ++i) {
+      t.keys.push_back(i * 5);
+    }
+
+    t.keys.insert(t.keys.begin(), {7, 8, 9});
+    t.keys.erase(t.keys.begin(), t.keys.begin() + 3);
+
+    const ciel::shm_allocator<int> int_alloc(segment);
+    for (int i = 0; i < 100; ++i) {
+      t.groups.emplace_back(int_alloc);
+      for (int j = 0; j < i; ++j) {
+        t.groups.back().push_back(j);
+      }
+    }
+
+    // Copy between vectors in the segment takes the fancy pointer memcpy path.
+    ciel::shm_vector<uint64_t> copy(t.keys);
+    assert(copy == t.keys);
+  }
+
+  // A second mapping of the same segment, at another address.
+  {
+    ciel::shm_segment other = ciel::shm_segment::open(segment.fd());
+    assert(other.size() == segment.size());
+
+    const tables* t = other.root<tables>();
+    assert(t != nullptr);
+    assert(static_cast<const void*>(t) != segment.root<tables>());
+
+    assert(t->keys.size() == 100000);
+    assert(static_cast<const void*>(t->keys.data()) != segment.root<tables>()->keys.data());
+    for (uint64_t i = 0; i < 100000; ++i) {
+      assert(t->keys[i] == i * 5);
+    }
+
+    assert(t->groups.size() == 100);
+    assert(t->groups[99].size() == 99);
+    assert(t->groups[99][98] == 98);
+  }
+
+  // A forked sibling reads without copying.
+  const pid_t pid = fork();
+  assert(pid != -1);
+
+  if (pid == 0) {
+    const tables* t = segment.root<tables>();
+    uint64_t sum = 0;
+    for (const uint64_t x : t->keys) {
+      sum += x;
+    }
+    _exit(sum == 5 * (uint64_t{100000} * 99999 / 2) && t->groups[50].size() == 50 ? 0 : 1);
+  }
+
+  int status = 0;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  segment.destroy_root<tables>();
+  assert(segment.arena().free_bytes() == initial_free);
+}
+
+void test_arena() {
+  ciel::shm_segment segment(1 << 16);
+  ciel::shm_arena& arena = segment.arena();
+  const size_t initial_free = arena.free_bytes();
+
+  void* a = arena.allocate(100);
+  void* b = arena.allocate(1000);
+  void* c = arena.allocate(10);
+  assert(reinterpret_cast<uintptr_t>(a) % ciel::shm_arena::alignment == 0);
+  assert(reinterpret_cast<uintptr_t>(b) % ciel::shm_arena::alignment == 0);
+
+  arena.deallocate(b);
+  void* d = arena.allocate(500);
+  assert(d == b);
+
+  arena.deallocate(a);
+  arena.deallocate(c);
+  arena.deallocate(d);
+  assert(arena.free_bytes() == initial_free);
+
+#ifdef __cpp_exceptions
+  try {
+    static_cast<void>(arena.allocate(1 << 16));
+    assert(false);
+  } catch (const std::bad_alloc&) {
+  }
+
+  int fds[2];
+  assert(pipe(fds) == 0);
+
+  try {
+    static_cast<void>(ciel::shm_segment::open(fds[0]));
+    assert(false);
+  } catch (const std::exception&) {
+  }
+
+  close(fds[0]);
+  close(fds[1]);
+#endif
+}
+
+int main(int, char**) {
+  test_offset_ptr();
+  test_vector_in_segment();
+  test_arena();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
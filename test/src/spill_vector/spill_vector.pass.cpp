@@ -0,0 +1,159 @@
+// <ciel/spill_vector.hpp>
+
+#include <cassert>
+#include <ciel/spill_vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <utility>
+
+#include "count_new.h"
+
+namespace {
+
+struct record {
+  uint64_t key;
+  uint32_t a;
+  uint32_t b;
+};
+
+}  // namespace
+
+void test_append_and_scan() {
+  // 512 elements per chunk, at most 3 chunks resident.
+  ciel::spill_vector<uint64_t> v(3 * 4096, 4096);
+  assert(v.chunk_size() == 512);
+  assert(v.max_resident_chunks() == 3);
+
+  constexpr uint64_t n = 100000;
+  for (uint64_t i = 0; i < n; ++i) {
+    v.push_back(i * 3);
+    assert(v.resident_chunks() <= 3);
+  }
+
+  assert(v.size() == n);
+  assert(v.spill_count() > 0);
+
+  uint64_t sum = 0;
+  uint64_t count = 0;
+  v.for_each_chunk([&](std::span<const uint64_t> s) {
+    for (const uint64_t x : s) {
+      assert(x == count * 3);
+      sum += x;
+      ++count;
+    }
+  });
+  assert(count == n);
+  assert(sum == 3 * n * (n - 1) / 2);
+  assert(v.resident_chunks() <= 3);
+
+  // Appending after a scan faults the last chunk back in if needed.
+  v.push_back(7);
+  assert(v.get(n) == 7);
+}
+
+void test_random_access() {
+  ciel::spill_vector<record> v(4 * 1024, 1024);
+
+  constexpr uint32_t n = 20000;
+  for (uint32_t i = 0; i < n; ++i) {
+    v.emplace_back(record{i, i + 1, i + 2});
+  }
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<uint32_t> dist(0, n - 1);
+
+  // Writes through operator[] survive being spilled and faulted in.
+  for (int i = 0; i < 5000; ++i) {
+    const uint32_t pos = dist(gen);
+    v[pos].b = pos * 2;
+  }
+
+  for (int i = 0; i < 5000; ++i) {
+    const uint32_t pos = dist(gen);
+    const record& r = v.get(pos);
+    assert(r.key == pos);
+    assert(r.a == pos + 1);
+    assert(r.b == pos + 2 || r.b == pos * 2);
+  }
+
+  assert(v.fault_count() > 0);
+  assert(v.resident_chunks() <= v.max_resident_chunks());
+
+  gen.seed(42);
+  for (int i = 0; i < 5000; ++i) {
+    const uint32_t pos = dist(gen);
+    assert(v.at(pos).b == pos * 2);
+  }
+
+#ifdef __cpp_exceptions
+  try {
+    static_cast<void>(v.at(n));
+    assert(false);
+  } catch (const std::out_of_range&) {
+  }
+#endif
+}
+
+void test_pop_back() {
+  ciel::spill_vector<uint32_t> v(0, 64);
+  assert(v.max_resident_chunks() == 2);
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    v.push_back(i);
+  }
+
+  // Touch the front so that the last chunks get spilled.
+  assert(v.get(0) == 0);
+  assert(v.get(16) == 16);
+
+  while (v.size() > 500) {
+    v.pop_back();
+  }
+
+  v.push_back(12345);
+  assert(v.size() == 501);
+  assert(v.get(499) == 499);
+  assert(v.get(500) == 12345);
+
+  while (!v.empty()) {
+    v.pop_back();
+  }
+  assert(v.resident_chunks() == 0);
+
+  v.push_back(1);
+  assert(v.get(0) == 1);
+}
+
+void test_move() {
+  ciel::spill_vector<uint16_t> v(256, 64);
+  for (uint16_t i = 0; i < 1000; ++i) {
+    v.push_back(i);
+  }
+
+  ciel::spill_vector<uint16_t> v2(std::move(v));
+  assert(v.empty());
+  assert(v2.size() == 1000);
+  assert(v2.get(3) == 3);
+
+  v = std::move(v2);
+  assert(v.size() == 1000);
+  assert(v.get(999) == 999);
+
+  v.clear();
+  assert(v.empty());
+  v.push_back(5);
+  assert(v.get(0) == 5);
+}
+
+int main(int, char**) {
+  test_append_and_scan();
+  test_random_access();
+  test_pop_back();
+  test_move();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+// <ciel/static_search_index.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <ciel/static_search_index.hpp>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+
+#include "count_new.h"
+
+template <class T>
+void test(const std::size_t n, const std::uint64_t modulo) {
+  std::mt19937_64 gen(n);
+  ciel::vector<T> keys;
+  for (std::size_t i = 0; i < n; ++i) {
+    keys.emplace_back(static_cast<T>(gen() % modulo));
+  }
+  if (n > 2) {
+    keys[0] = std::numeric_limits<T>::min();
+    keys[1] = std::numeric_limits<T>::max();
+  }
+  std::sort(keys.begin(), keys.end());
+
+  const ciel::static_search_index<T> index(keys);
+  assert(index.size() == n);
+  assert(std::ranges::equal(index.keys(), keys));
+
+  ciel::vector<T> queries;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    queries.emplace_back(static_cast<T>(gen() % (modulo + 2)));
+  }
+  queries.emplace_back(std::numeric_limits<T>::min());
+  queries.emplace_back(std::numeric_limits<T>::max());
+  queries.insert(queries.end(), keys.begin(), keys.begin() + std::min<std::size_t>(n, 1000));
+
+  ciel::vector<std::size_t> batch(queries.size());
+  index.lower_bound(queries, batch);
+
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    const T x = queries[i];
+    const auto lower = static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), x) - keys.begin());
+    const auto upper = static_cast<std::size_t>(std::upper_bound(keys.begin(), keys.end(), x) - keys.begin());
+
+    assert(index.lower_bound(x) == lower);
+    assert(batch[i] == lower);
+    assert(index.upper_bound(x) == upper);
+    assert(index.contains(x) == std::binary_search(keys.begin(), keys.end(), x));
+  }
+
+  // Copies are rebuilt with their own alignment.
+  const ciel::static_search_index<T> copy(index);
+  assert(std::ranges::equal(copy.keys(), keys));
+  assert(copy.height() == index.height());
+
+  ciel::static_search_index<T> moved(std::move(const_cast<ciel::static_search_index<T>&>(copy)));
+  assert(copy.empty());
+  assert(copy.lower_bound(queries[0]) == 0);
+  assert(moved.size() == n);
+  if (n != 0) {
+    assert(moved[n - 1] == keys[n - 1]);
+  }
+}
+
+template <class T>
+void test_sizes() {
+  for (const std::size_t n : {0, 1, 2, 15, 16, 17, 100, 1000, 4096, 100000}) {
+    test<T>(n, 1000);
+    test<T>(n, std::numeric_limits<T>::max() / 2);
+  }
+}
+
+int main(int, char**) {
+  test_sizes<std::uint32_t>();
+  test_sizes<std::int32_t>();
+  test_sizes<std::uint64_t>();
+  test_sizes<std::int64_t>();
+  test_sizes<std::int16_t>();
+
+  {
+    const ciel::vector<int> keys{1, 3, 5, 7};
+    const ciel::static_search_index<int> index(keys);
+    assert(index.height() == 1);
+    assert(index.lower_bound(0) == 0);
+    assert(index.lower_bound(4) == 2);
+    assert(index.lower_bound(8) == 4);
+    assert(index.contains(5));
+    assert(!index.contains(6));
+  }
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
@@ -0,0 +1,121 @@
+// <ciel/string_vector.hpp>
+
+#include <cassert>
+#include <ciel/string_vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "count_new.h"
+#include "min_allocator.h"
+
+static_assert(std::random_access_iterator<ciel::string_vector<>::const_iterator>);
+static_assert(std::ranges::random_access_range<const ciel::string_vector<>>);
+
+template <class S>
+void test() {
+  {
+    S v;
+    assert(v.empty());
+    assert(v.begin() == v.end());
+
+    assert(v.emplace_back("hello") == "hello");
+    v.push_back("");
+    v.push_back(std::string("world"));
+    assert(v.size() == 3);
+    assert(v.chars_size() == 10);
+    assert(v[0] == "hello");
+    assert(v[1].empty());
+    assert(v.at(2) == "world");
+    assert(v.front() == "hello");
+    assert(v.back() == "world");
+
+    // Self referencing push_back.
+    for (int i = 0; i < 20; ++i) {
+      v.push_back(v[0]);
+    }
+    assert(v.size() == 23);
+    assert(v.back() == "hello");
+
+    v.pop_back();
+    assert(v.size() == 22);
+    assert(v.chars_size() == 10 + 19 * 5);
+
+    std::size_t total = 0;
+    for (std::string_view s : v) {
+      total += s.size();
+    }
+    assert(total == v.chars_size());
+    assert(v.end() - v.begin() == 22);
+
+    v.clear();
+    assert(v.empty());
+    assert(v.chars_size() == 0);
+    v.shrink_to_fit();
+  }
+  {
+    std::vector<std::string> words;
+    for (int i = 0; i < 1000; ++i) {
+      words.push_back(std::to_string(i * 7919));
+    }
+
+    S v(words);
+    assert(v.size() == words.size());
+    assert(std::ranges::equal(v, words));
+
+    std::list<std::string> more{"a", "bb", "ccc"};
+    v.append(more);
+    v.append(std::views::iota(0, 3) | std::views::transform([](int) { return std::string_view("x"); }));
+    assert(v.size() == 1006);
+    assert(v[1004] == "x");
+    assert(v[1002] == "ccc");
+
+    S copy = v;
+    assert(copy == v);
+    copy.pop_back();
+    assert(!(copy == v));
+  }
+  {
+    const S v{"a", "b"};
+    assert(v.size() == 2);
+    assert(v[1] == "b");
+  }
+}
+
+int main(int, char**) {
+  {
+    test<ciel::string_vector<>>();
+    test<ciel::string_vector<std::uint32_t>>();
+    test<ciel::string_vector<std::size_t, min_allocator<char>>>();
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+  {
+    std::vector<std::string> words(100, std::string(50, 'a'));
+
+    globalMemCounter.reset();
+    ciel::string_vector<std::uint32_t> v;
+    v.append(words);
+    assert(globalMemCounter.checkNewCalledEq(2));  // one reservation for each array
+  }
+  {
+    // Offsets that would overflow offset_type are rejected.
+    ciel::string_vector<std::uint8_t> v;
+    v.push_back(std::string(200, 'a'));
+    bool thrown = false;
+    try {
+      v.push_back(std::string(56, 'a'));
+    } catch (const std::length_error&) {
+      thrown = true;
+    }
+    assert(thrown);
+    assert(v.size() == 1);
+    assert(v.chars_size() == 200);
+  }
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+// <ciel/vector.hpp>
+
+// allocator_has_trivial_construct and allocator_has_trivial_destroy across allocators, and the opt-in through
+// nested has_trivial_construct and has_trivial_destroy.
+
+#include <cassert>
+#include <ciel/aligned_allocator.hpp>
+#include <ciel/arena_allocator.hpp>
+#include <ciel/malloc_allocator.hpp>
+#include <ciel/pool_allocator.hpp>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "allocators.h"
+#include "count_new.h"
+#include "min_allocator.h"
+#include "sized_allocator.h"
+#include "test_allocator.h"
+
+namespace {
+
+struct relocatable {
+  int* p;
+
+  explicit relocatable(const int i) : p(new int{i}) {}
+
+  relocatable(const relocatable& other) : p(new int{*other.p}) {}
+
+  relocatable(relocatable&& other) noexcept : p(std::exchange(other.p, nullptr)) {}
+
+  relocatable& operator=(relocatable&& other) noexcept {
+    delete p;
+    p = std::exchange(other.p, nullptr);
+    return *this;
+  }
+
+  ~relocatable() { delete p; }
+};
+
+int constructs = 0;
+int destroys = 0;
+
+// Counts construct and destroy calls, they have no other effect.
+template <class T, bool Declared>
+class logging_allocator {
+ public:
+  using value_type = T;
+
+  logging_allocator() noexcept = default;
+
+  template <class U>
+  logging_allocator(const logging_allocator<U, Declared>&) noexcept {}
+
+  template <class U>
+  struct rebind {
+    using other = logging_allocator<U, Declared>;
+  };
+
+  T* allocate(const size_t n) { return std::allocator<T>().allocate(n); }
+
+  void deallocate(T* p, const size_t n) noexcept { std::allocator<T>().deallocate(p, n); }
+
+  template <class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    ++constructs;
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <class U>
+  void destroy(U* p) noexcept {
+    ++destroys;
+    p->~U();
+  }
+
+  template <class U>
+  friend bool operator==(const logging_allocator&, const logging_allocator<U, Declared>&) noexcept {
+    return true;
+  }
+};
+
+template <class T>
+class declared_logging_allocator : public logging_allocator<T, true> {
+ public:
+  using has_trivial_construct = std::true_type;
+  using has_trivial_destroy = std::true_type;
+
+  declared_logging_allocator() noexcept = default;
+
+  template <class U>
+  declared_logging_allocator(const declared_logging_allocator<U>&) noexcept {}
+
+  template <class U>
+  struct rebind {
+    using other = declared_logging_allocator<U>;
+  };
+};
+
+// Has no construct or destroy, but opts out.
+template <class T>
+class opted_out_allocator : public std::allocator<T> {
+ public:
+  using has_trivial_construct = std::false_type;
+  using has_trivial_destroy = std::false_type;
+
+  opted_out_allocator() noexcept = default;
+
+  template <class U>
+  opted_out_allocator(const opted_out_allocator<U>&) noexcept {}
+
+  template <class U>
+  struct rebind {
+    using other = opted_out_allocator<U>;
+  };
+};
+
+template <class Alloc, bool Expected>
+constexpr bool check() {
+  using T = std::allocator_traits<Alloc>::value_type;
+
+  static_assert(ciel::allocator_has_trivial_construct<Alloc, T*, const T&>::value == Expected);
+  static_assert(ciel::allocator_has_trivial_construct<Alloc, T*, T&&>::value == Expected);
+  static_assert(ciel::allocator_has_trivial_destroy<Alloc, T*>::value == Expected);
+
+  static_assert(ciel::vector<T, Alloc>::expand_via_memcpy == Expected);
+  static_assert(ciel::vector<T, Alloc>::move_via_memmove == Expected);
+
+  return true;
+}
+
+}  // namespace
+
+template <>
+struct ciel::is_trivially_relocatable<relocatable> : std::true_type {};
+
+// Without construct or destroy.
+static_assert(check<std::allocator<relocatable>, true>());
+static_assert(check<bare_allocator<relocatable>, true>());
+static_assert(check<min_allocator<relocatable>, true>());
+static_assert(check<explicit_allocator<relocatable>, true>());
+static_assert(check<sized_allocator<relocatable>, true>());
+static_assert(check<other_allocator<relocatable>, true>());
+static_assert(check<ciel::aligned_allocator<relocatable>, true>());
+static_assert(check<ciel::malloc_allocator<relocatable>, true>());
+static_assert(check<ciel::pool_allocator<relocatable>, true>());
+static_assert(check<ciel::arena_allocator<relocatable>, true>());
+
+// With construct and destroy.
+static_assert(check<A3<relocatable>, false>());
+static_assert(check<test_allocator<relocatable>, false>());
+static_assert(check<logging_allocator<relocatable, false>, false>());
+
+// Declared.
+static_assert(check<declared_logging_allocator<relocatable>, true>());
+static_assert(check<opted_out_allocator<relocatable>, false>());
+
+// Returns the number of construct and destroy calls.
+template <class Alloc>
+std::pair<int, int> test_relocation() {
+  constructs = 0;
+  destroys = 0;
+
+  {
+    ciel::vector<relocatable, Alloc> v;
+    v.reserve(1);
+
+    for (int i = 0; i < 10; ++i) {
+      v.emplace_back(i);
+    }
+
+    v.insert(v.begin(), relocatable(-1));
+    v.erase(v.begin());
+
+    for (int i = 0; i < 10; ++i) {
+      assert(*v[i].p == i);
+    }
+  }
+
+  return {constructs, destroys};
+}
+
+int main() {
+  // Reallocations from capacity 1 to 2, 4, 8 and 16 alone move 1 + 2 + 4 + 8 elements.
+  const std::pair<int, int> counts = test_relocation<logging_allocator<relocatable, false>>();
+  assert(counts.first > 10 + 1 + 15);
+  assert(counts.second > 1 + 10 + 15);
+
+  // Only the 10 emplace_backs and the insert construct, only the erase and the destructor destroy, everything
+  // else is memcpy and memmove.
+  assert(test_relocation<declared_logging_allocator<relocatable>>() == std::make_pair(10 + 1, 1 + 10));
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
@@ -0,0 +1,101 @@
+// <ciel/vector.hpp>
+
+// void reserve_spare(size_type count);
+// void unchecked_set_size(size_type count) noexcept;
+
+#include <cassert>
+#include <ciel/vector.hpp>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "min_allocator.h"
+#include "test_macros.h"
+
+template <class C>
+constexpr void test_reserve_spare() {
+  C v;
+  v.reserve_spare(0);
+  assert(v.capacity() == 0);
+
+  v.reserve_spare(10);
+  assert(v.capacity() >= 10);
+
+  // Enough room already.
+  const auto data = v.data();
+  const auto cap = v.capacity();
+  v.reserve_spare(cap);
+  assert(v.data() == data);
+  assert(v.capacity() == cap);
+
+  // Grows geometrically, like push_back.
+  v.resize(cap);
+  v.reserve_spare(1);
+  assert(v.capacity() >= cap * 2);
+  assert(v.size() == cap);
+}
+
+template <class C>
+constexpr void test_unchecked_set_size() {
+  C v{0, 1, 2};
+  v.reserve_spare(5);
+
+  for (int i = 3; i < 8; ++i) {
+    std::construct_at(std::to_address(v.data()) + i, i);
+  }
+
+  ASSERT_NOEXCEPT(v.unchecked_set_size(8));
+  v.unchecked_set_size(8);
+  assert(v.size() == 8);
+  for (int i = 0; i < 8; ++i) {
+    assert(v[i] == i);
+  }
+
+  // Dropping trivially destructible elements.
+  v.unchecked_set_size(2);
+  assert(v.size() == 2);
+  assert(v.back() == 1);
+}
+
+constexpr bool tests() {
+  test_reserve_spare<ciel::vector<int>>();
+  test_reserve_spare<ciel::vector<int, min_allocator<int>>>();
+  test_unchecked_set_size<ciel::vector<int>>();
+  test_unchecked_set_size<ciel::vector<int, min_allocator<int>>>();
+
+  return true;
+}
+
+void test_bytes() {
+  const char text[] = "written past the end";
+
+  ciel::vector<char> v{'>'};
+  v.reserve_spare(sizeof(text));
+  std::memcpy(v.data() + v.size(), text, sizeof(text));
+  v.unchecked_set_size(v.size() + sizeof(text));
+
+  assert(v.size() == sizeof(text) + 1);
+  assert(std::strcmp(v.data() + 1, text) == 0);
+}
+
+void test_length_error() {
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  ciel::vector<int> v{1};
+  try {
+    v.reserve_spare(v.max_size());
+    assert(false);
+  } catch (const std::length_error&) {
+  }
+  assert(v.size() == 1);
+#endif
+}
+
+int main(int, char**) {
+  tests();
+  static_assert(tests());
+
+  test_bytes();
+  test_length_error();
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+// <ciel/vector.hpp>
+
+// vector(size_type) and resize(size_type) value-initialize zero initializable elements by allocating a zeroed
+// buffer when the allocator has allocate_zeroed.
+
+#include <cassert>
+#include <ciel/malloc_allocator.hpp>
+#include <ciel/vector.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include "count_new.h"
+
+namespace {
+
+struct point {
+  int x;
+  int y;
+};
+
+struct member {
+  int point::* p;
+};
+
+int zeroed_allocations = 0;
+
+// allocate returns garbage, so elements that weren't value-initialized would show.
+template <class T>
+class garbage_allocator {
+ public:
+  using value_type = T;
+
+  garbage_allocator() noexcept = default;
+
+  template <class U>
+  garbage_allocator(const garbage_allocator<U>&) noexcept {}
+
+  T* allocate(const size_t n) {
+    void* res = std::malloc(n * sizeof(T));
+    std::memset(res, 0xAB, n * sizeof(T));
+    return static_cast<T*>(res);
+  }
+
+  T* allocate_zeroed(const size_t n) {
+    ++zeroed_allocations;
+    return static_cast<T*>(std::calloc(n, sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+  template <class U>
+  friend bool operator==(const garbage_allocator&, const garbage_allocator<U>&) noexcept {
+    return true;
+  }
+};
+
+}  // namespace
+
+template <>
+struct ciel::is_zero_initializable<point> : std::true_type {};
+
+static_assert(ciel::is_zero_initializable_v<double>);
+static_assert(ciel::is_zero_initializable_v<std::byte>);
+static_assert(ciel::is_zero_initializable_v<int*>);
+static_assert(!ciel::is_zero_initializable_v<int point::*>);
+static_assert(!ciel::is_zero_initializable_v<member>);
+
+static_assert(ciel::allocator_has_allocate_zeroed<ciel::malloc_allocator<int>>::value);
+static_assert(!ciel::allocator_has_allocate_zeroed<std::allocator<int>>::value);
+
+template <class T>
+void check_zero(const ciel::vector<T, garbage_allocator<T>>& v) {
+  for (const T& x : v) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &x, sizeof(T));
+
+    for (const unsigned char b : bytes) {
+      assert(b == 0);
+    }
+  }
+}
+
+void test_construct() {
+  zeroed_allocations = 0;
+
+  ciel::vector<double, garbage_allocator<double>> v(1000);
+  assert(v.size() == 1000);
+  assert(zeroed_allocations == 1);
+  check_zero(v);
+
+  ciel::vector<point, garbage_allocator<point>> points(1000);
+  assert(zeroed_allocations == 2);
+  check_zero(points);
+
+  // Not zero initializable, constructed one by one.
+  ciel::vector<member, garbage_allocator<member>> members(10);
+  assert(zeroed_allocations == 2);
+  for (const member& m : members) {
+    assert(m.p == nullptr);
+  }
+}
+
+void test_resize() {
+  zeroed_allocations = 0;
+
+  ciel::vector<int, garbage_allocator<int>> v;
+  v.resize(100);
+  assert(zeroed_allocations == 1);
+  check_zero(v);
+
+  v[0] = 1;
+  v[99] = 2;
+
+  // Old elements are moved into the zeroed buffer.
+  v.resize(1000);
+  assert(zeroed_allocations == 2);
+  assert(v[0] == 1);
+  assert(v[99] == 2);
+  v[0] = 0;
+  v[99] = 0;
+  check_zero(v);
+
+  // Within capacity, the spare capacity is value-initialized in place.
+  v.resize(10);
+  v.resize(v.capacity());
+  assert(zeroed_allocations == 2);
+  check_zero(v);
+
+  // Small steps reallocate normally, a zeroed buffer would clear far more than they append.
+  v.resize(v.size() + 1);
+  assert(zeroed_allocations == 2);
+  check_zero(v);
+}
+
+void test_malloc_allocator() {
+  ciel::vector<double, ciel::malloc_allocator<double>> v(size_t{1} << 20);
+
+  for (const double x : v) {
+    assert(x == 0.0);
+  }
+}
+
+int main() {
+  test_construct();
+  test_resize();
+  test_malloc_allocator();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
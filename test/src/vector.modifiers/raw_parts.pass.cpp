@@ -0,0 +1,114 @@
+// <ciel/vector.hpp>
+
+// static vector adopt(pointer data, size_type size, size_type capacity, const allocator_type& alloc = {});
+// static vector adopt(const raw_parts& parts, const allocator_type& alloc = {});
+// raw_parts into_raw_parts() noexcept;
+// pointer release() noexcept;
+
+#include <cassert>
+#include <ciel/malloc_allocator.hpp>
+#include <ciel/vector.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "count_new.h"
+#include "min_allocator.h"
+#include "test_macros.h"
+
+template <class C>
+constexpr void test_round_trip() {
+  using T = typename C::value_type;
+
+  C v;
+  for (int i = 0; i < 10; ++i) {
+    v.emplace_back(T(i));
+  }
+
+  const auto data = v.data();
+  const auto cap = v.capacity();
+
+  ASSERT_NOEXCEPT(v.into_raw_parts());
+  auto parts = v.into_raw_parts();
+  assert(v.empty());
+  assert(v.capacity() == 0);
+  assert(v.data() == nullptr);
+  assert(std::to_address(parts.data) == data);
+  assert(parts.size == 10);
+  assert(parts.capacity == cap);
+
+  C v2 = C::adopt(parts, v.get_allocator());
+  assert(v2.data() == data);
+  assert(v2.size() == 10);
+  assert(v2.capacity() == cap);
+  for (int i = 0; i < 10; ++i) {
+    assert(v2[i] == T(i));
+  }
+
+  // Still an ordinary vector.
+  v2.emplace_back(T(10));
+  assert(v2.back() == T(10));
+
+  // Adopting nothing.
+  C v3 = C::adopt(nullptr, 0, 0);
+  assert(v3.empty());
+  assert(v3.capacity() == 0);
+}
+
+constexpr bool tests() {
+  test_round_trip<ciel::vector<int>>();
+  test_round_trip<ciel::vector<int, min_allocator<int>>>();
+
+  return true;
+}
+
+void test_non_trivial() {
+  ciel::vector<std::string> v{"a", "bb", "a long string that is not in the small buffer"};
+  std::allocator<std::string> alloc = v.get_allocator();
+
+  const auto parts = v.into_raw_parts();
+  assert(parts.size == 3);
+  assert(parts.data[2] == "a long string that is not in the small buffer");
+
+  // The caller owns the elements and the buffer now.
+  std::destroy_n(parts.data, parts.size);
+  alloc.deallocate(parts.data, parts.capacity);
+}
+
+void test_c_interop() {
+  // A C API hands over a malloc'd buffer.
+  int* buffer = static_cast<int*>(std::malloc(100 * sizeof(int)));
+  assert(buffer != nullptr);
+  for (int i = 0; i < 50; ++i) {
+    buffer[i] = i;
+  }
+
+  using C = ciel::vector<int, ciel::malloc_allocator<int>>;
+
+  C v = C::adopt(buffer, 50, 100);
+  assert(v.data() == buffer);
+  v.resize(100, 1);
+  assert(v.data() == buffer);
+  v.push_back(2);
+  assert(v[49] == 49);
+  assert(v.back() == 2);
+
+  // And takes one back, freeing it itself.
+  int* released = v.release();
+  assert(v.empty());
+  assert(released[100] == 2);
+  std::free(released);
+}
+
+int main(int, char**) {
+  tests();
+  static_assert(tests());
+
+  test_non_trivial();
+  test_c_interop();
+
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}